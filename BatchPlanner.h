@@ -0,0 +1,78 @@
+// BatchPlanner.h - Plans many flight queries in parallel for fleet dispatch
+#ifndef BATCHPLANNER_H
+#define BATCHPLANNER_H
+
+#include "Common.h"
+#include "Map.h"
+#include "Drone.h"
+#include "PathFinder.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <memory>
+using namespace std;
+
+struct FlightQuery {
+    Vector3D start;
+    Vector3D dest;
+    const Drone* drone;     // optional; used for the battery check
+
+    FlightQuery(Vector3D s = Vector3D(), Vector3D d = Vector3D(), const Drone* dr = nullptr)
+        : start(s), dest(d), drone(dr) {}
+};
+
+struct FlightPlan {
+    vector<Vector3D> path;
+    double distance;
+    double batteryRequired;     // charge units at the drone's consumption rate
+    bool batteryOk;             // false if the drone cannot fly this route on its current charge
+
+    FlightPlan() : distance(0), batteryRequired(0), batteryOk(true) {}
+};
+
+// Fans a batch of queries over a thread pool. Each worker owns a PathFinder3D
+// (and so its own search workspace); all of them read the same Map3D and share
+// one locked path cache, so a route solved by any worker is a hit for the rest.
+// The map must not be modified while planBatch is running.
+class BatchPlanner {
+private:
+    const Map3D* map;
+    ThreadPool pool;
+    PathCache sharedCache;
+    vector<unique_ptr<PathFinder3D>> planners;
+
+public:
+    BatchPlanner(const Map3D* m, int threads = (int)thread::hardware_concurrency(),
+                 double gridStep = 1.0, size_t cacheBudget = 4 * 1024 * 1024)
+        : map(m), pool(threads), sharedCache(cacheBudget) {
+        for (int i = 0; i < pool.size(); i++) {
+            planners.push_back(make_unique<PathFinder3D>(map, gridStep));
+            planners.back()->setSharedCache(&sharedCache);
+        }
+    }
+
+    // results are returned in input order
+    vector<FlightPlan> planBatch(const FlightQuery* queries, size_t count) {
+        vector<FlightPlan> plans(count);
+        pool.parallelFor(count, [&](size_t i, int worker) {
+            const FlightQuery& q = queries[i];
+            FlightPlan& plan = plans[i];
+            plan.path = planners[worker]->findPath(q.start, q.dest);
+            plan.distance = pathLength(plan.path);
+            if (q.drone) {
+                const Battery& battery = q.drone->getBattery();
+                plan.batteryRequired = plan.distance * battery.getConsumptionRate();
+                plan.batteryOk = battery.canTravel(plan.distance);
+            }
+        });
+        return plans;
+    }
+
+    vector<FlightPlan> planBatch(const vector<FlightQuery>& queries) {
+        return planBatch(queries.data(), queries.size());
+    }
+
+    int getThreadCount() const { return pool.size(); }
+    PathCache& getCache() { return sharedCache; }
+};
+
+#endif
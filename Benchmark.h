@@ -0,0 +1,1467 @@
+// Benchmark.h - Performance measurements for planners and maps
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "Common.h"
+#include "Map.h"
+#include "PathFinder.h"
+#include "GridPathFinder.h"
+#include "BatchPlanner.h"
+#include "MissionLog.h"
+#include "MissionWriter.h"
+#include "MissionStats.h"
+#include "MissionAnalytics.h"
+#include "PathSoA.h"
+#include "HierarchicalPathFinder.h"
+#include "JumpPointFinder.h"
+#include "ThetaStarFinder.h"
+#include "BidirectionalPathFinder.h"
+#include "DStarLitePathFinder.h"
+#include "Simulator.h"
+#include "FleetSimulator.h"
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <queue>
+using namespace std;
+
+// wall-clock timer for benchmark sections
+class Stopwatch {
+private:
+    chrono::steady_clock::time_point startTime;
+public:
+    Stopwatch() : startTime(chrono::steady_clock::now()) {}
+    void restart() { startTime = chrono::steady_clock::now(); }
+    double elapsedMs() const {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
+    }
+};
+
+// puts back an ostream's flags, precision and fill on scope exit, so one
+// benchmark's fixed/setprecision does not leak into the next one
+class StreamStateGuard {
+private:
+    ostream& out;
+    ios::fmtflags flags;
+    streamsize precision;
+    char fill;
+public:
+    explicit StreamStateGuard(ostream& os = cout)
+        : out(os), flags(os.flags()), precision(os.precision()), fill(os.fill()) {}
+    ~StreamStateGuard() {
+        out.flags(flags);
+        out.precision(precision);
+        out.fill(fill);
+    }
+};
+
+// synthetic city: random box buildings on the ground plane
+inline Map3D makeRandomCity(int width, int depth, int height, int buildings, unsigned seed = 7) {
+    Map3D city(width, depth, height, "Synthetic City");
+    mt19937 rng(seed);
+    uniform_real_distribution<double> px(0, width - 2), py(0, depth - 2);
+    uniform_real_distribution<double> size(1, 6), tall(2, height * 0.8);
+    for (int i = 0; i < buildings; i++) {
+        city.addObstacle(Obstacle(Vector3D(px(rng), py(rng), 0), size(rng), size(rng), tall(rng)));
+    }
+    return city;
+}
+
+struct PlanQuery {
+    Vector3D start;
+    Vector3D end;
+};
+
+// random free start/destination pairs (fixed seed so runs are comparable)
+inline vector<PlanQuery> makeRandomQueries(const Map3D& map, int count, unsigned seed = 42,
+                                           int maxZ = 6) {
+    mt19937 rng(seed);
+    uniform_int_distribution<int> rx(0, map.getWidth() - 1);
+    uniform_int_distribution<int> ry(0, map.getDepth() - 1);
+    uniform_int_distribution<int> rz(1, max(1, min(maxZ, map.getHeight() - 1)));
+    vector<PlanQuery> queries;
+    int attempts = 0;
+    while ((int)queries.size() < count && attempts < count * 100) {
+        attempts++;
+        Vector3D a(rx(rng), ry(rng), rz(rng));
+        Vector3D b(rx(rng), ry(rng), rz(rng));
+        if (map.isBlocked(a) || map.isBlocked(b) || a.distanceTo(b) < 5) continue;
+        queries.push_back({a, b});
+    }
+    return queries;
+}
+
+// run two planners on identical queries and report time and path length side by side
+inline void benchPathFinderAB(const Map3D& map, IPathFinder& a, const string& nameA,
+                              IPathFinder& b, const string& nameB,
+                              const vector<PlanQuery>& queries) {
+    StreamStateGuard streamState;
+    double timeA = 0, timeB = 0, lenA = 0, lenB = 0;
+    int longerA = 0, longerB = 0;
+    for (const auto& q : queries) {
+        Stopwatch sw;
+        auto pathA = a.findPath(q.start, q.end);
+        timeA += sw.elapsedMs();
+        sw.restart();
+        auto pathB = b.findPath(q.start, q.end);
+        timeB += sw.elapsedMs();
+
+        double la = pathLength(pathA), lb = pathLength(pathB);
+        lenA += la;
+        lenB += lb;
+        if (la > lb + 0.01) longerA++;
+        else if (lb > la + 0.01) longerB++;
+    }
+
+    cout << "\nA/B on " << queries.size() << " queries (" << map.getName() << ")\n";
+    cout << left << setw(18) << "Planner" << setw(14) << "Total ms"
+         << setw(14) << "ms/query" << setw(16) << "Total length" << "Longer paths\n";
+    cout << string(72, '-') << "\n";
+    size_t n = max<size_t>(1, queries.size());
+    cout << fixed << setprecision(3);
+    cout << left << setw(18) << nameA << setw(14) << timeA << setw(14) << timeA / n
+         << setw(16) << lenA << longerA << "\n";
+    cout << left << setw(18) << nameB << setw(14) << timeB << setw(14) << timeB / n
+         << setw(16) << lenB << longerB << "\n";
+    if (timeB > 0) cout << "Speedup " << nameA << "/" << nameB << ": " << timeA / timeB << "x\n";
+}
+
+// open-set behaviour: PathFinder3D with lazy duplicate pushes vs indexed decrease-key
+inline void benchOpenSet(const Map3D& map, int queryCount = 50) {
+    StreamStateGuard streamState;
+    auto queries = makeRandomQueries(map, queryCount);
+    PathFinder3D indexed(&map, 1.0);
+    indexed.setCacheBudget(0);
+    PathFinder3D lazy(&map, 1.0);
+    lazy.setCacheBudget(0);
+    lazy.setLazyOpenSet(true);
+
+    SearchStats lazyTotal, indexedTotal;
+    double lazyPeakSum = 0, indexedPeakSum = 0, lazyMs = 0, indexedMs = 0;
+    for (const auto& q : queries) {
+        Stopwatch sw;
+        lazy.findPath(q.start, q.end);
+        lazyMs += sw.elapsedMs();
+        lazyTotal.add(lazy.getLastStats());
+        lazyPeakSum += lazy.getLastStats().peakOpenSize;
+
+        sw.restart();
+        indexed.findPath(q.start, q.end);
+        indexedMs += sw.elapsedMs();
+        indexedTotal.add(indexed.getLastStats());
+        indexedPeakSum += indexed.getLastStats().peakOpenSize;
+    }
+
+    size_t n = max<size_t>(1, queries.size());
+    cout << "\nOpen set on " << queries.size() << " queries (" << map.getName() << ")\n";
+    cout << left << setw(26) << "Open set" << setw(13) << "Expansions" << setw(12) << "Push/exp"
+         << setw(13) << "Decr-keys" << setw(12) << "Stale pops" << setw(11) << "Avg peak"
+         << setw(10) << "Max peak" << "ms\n";
+    cout << string(105, '-') << "\n";
+    cout << fixed << setprecision(2);
+    cout << left << setw(26) << "Lazy binary heap" << setw(13) << lazyTotal.expansions
+         << setw(12) << lazyTotal.pushesPerExpansion() << setw(13) << lazyTotal.decreaseKeys
+         << setw(12) << lazyTotal.stalePops << setw(11) << lazyPeakSum / n
+         << setw(10) << lazyTotal.peakOpenSize << lazyMs << "\n";
+    cout << left << setw(26) << "Indexed 4-ary heap" << setw(13) << indexedTotal.expansions
+         << setw(12) << indexedTotal.pushesPerExpansion() << setw(13) << indexedTotal.decreaseKeys
+         << setw(12) << indexedTotal.stalePops << setw(11) << indexedPeakSum / n
+         << setw(10) << indexedTotal.peakOpenSize << indexedMs << "\n";
+}
+
+// planBatch throughput (queries/sec) as the thread count grows
+inline void benchBatchPlanning(const Map3D& map, int queryCount = 400) {
+    StreamStateGuard streamState;
+    auto base = makeRandomQueries(map, queryCount / 2, 11);
+    vector<FlightQuery> queries;
+    for (int round = 0; round < 2; round++) {      // second half repeats routes -> cache hits
+        for (const auto& q : base) queries.push_back(FlightQuery(q.start, q.end));
+    }
+
+    cout << "\nplanBatch on " << queries.size() << " queries (" << map.getName() << ", "
+         << thread::hardware_concurrency() << " hardware threads)\n";
+    cout << left << setw(10) << "Threads" << setw(12) << "ms" << setw(16) << "Queries/sec"
+         << setw(12) << "Speedup" << setw(12) << "Cache hits" << "Matches 1-thread\n";
+    cout << string(76, '-') << "\n";
+
+    vector<FlightPlan> reference;
+    double baseMs = 0;
+    const int threadCounts[] = {1, 2, 4, 8};
+    for (int threads : threadCounts) {
+        BatchPlanner planner(&map, threads);
+        Stopwatch sw;
+        auto plans = planner.planBatch(queries);
+        double ms = sw.elapsedMs();
+        if (reference.empty()) {
+            reference = plans;
+            baseMs = ms;
+        }
+        int matches = 0;
+        for (size_t i = 0; i < plans.size(); i++) {
+            if (fabs(plans[i].distance - reference[i].distance) < 1e-6) matches++;
+        }
+        cout << fixed << setprecision(1) << left << setw(10) << threads << setw(12) << ms
+             << setw(16) << (ms > 0 ? queries.size() * 1000.0 / ms : 0)
+             << setw(12) << (ms > 0 ? baseMs / ms : 0)
+             << setw(12) << planner.getCache().getHits()
+             << matches << "/" << plans.size() << "\n";
+    }
+}
+
+// isBlocked probe cost as the obstacle count grows, bucket grid vs linear scan
+inline void benchSpatialIndex(int probes = 200000) {
+    StreamStateGuard streamState;
+    cout << "\nMap3D::isBlocked probe cost (500x500x50 map, " << probes << " probes)\n";
+    cout << left << setw(12) << "Obstacles" << setw(16) << "Linear ns" << setw(16) << "Indexed ns"
+         << setw(12) << "Speedup" << "Bucket entries\n";
+    cout << string(68, '-') << "\n";
+
+    const int counts[] = {10, 100, 1000, 5000, 20000};
+    for (int n : counts) {
+        Map3D city = makeRandomCity(500, 500, 50, n);
+        mt19937 rng(99);
+        uniform_real_distribution<double> rx(0, 500), rz(0, 50);
+        vector<Vector3D> points;
+        points.reserve(probes);
+        for (int i = 0; i < probes; i++) points.push_back(Vector3D(rx(rng), rx(rng), rz(rng)));
+
+        int blockedLinear = 0, blockedIndexed = 0;
+        city.setSpatialIndexEnabled(false);
+        Stopwatch sw;
+        for (const auto& p : points) blockedLinear += city.isBlocked(p) ? 1 : 0;
+        double linearMs = sw.elapsedMs();
+
+        city.setSpatialIndexEnabled(true);
+        sw.restart();
+        for (const auto& p : points) blockedIndexed += city.isBlocked(p) ? 1 : 0;
+        double indexedMs = sw.elapsedMs();
+
+        cout << fixed << setprecision(1) << left << setw(12) << n
+             << setw(16) << linearMs * 1e6 / probes
+             << setw(16) << indexedMs * 1e6 / probes
+             << setw(12) << (indexedMs > 0 ? linearMs / indexedMs : 0)
+             << city.getObstacleIndex().getEntryCount()
+             << (blockedLinear != blockedIndexed ? "  MISMATCH" : "") << "\n";
+    }
+}
+
+// sampled isPathClear vs exact isSegmentClear: cost and missed collisions
+inline void benchSegmentClearance(int segments = 20000) {
+    StreamStateGuard streamState;
+    cout << "\nSegment clearance (" << segments << " random segments)\n";
+    cout << left << setw(12) << "Obstacles" << setw(14) << "Sampled us" << setw(14) << "Exact us"
+         << setw(16) << "Exact lin. us" << "Tunneled (sampled said clear)\n";
+    cout << string(80, '-') << "\n";
+
+    const int counts[] = {11, 1000, 5000};
+    for (int n : counts) {
+        Map3D city = (n == 11) ? Map3D(50, 25, 20, "Metro City") : makeRandomCity(500, 500, 50, n);
+        if (n == 11) city.loadPredefinedMap();
+        mt19937 rng(5);
+        uniform_real_distribution<double> rx(0, city.getWidth() - 0.01), ry(0, city.getDepth() - 0.01),
+            rz(0, city.getHeight() - 0.01);
+        vector<PlanQuery> segs;
+        for (int i = 0; i < segments; i++) {
+            segs.push_back({Vector3D(rx(rng), ry(rng), rz(rng)), Vector3D(rx(rng), ry(rng), rz(rng))});
+        }
+
+        int tunneled = 0, mismatch = 0;
+        vector<char> sampled(segs.size()), exact(segs.size());
+        Stopwatch sw;
+        for (size_t i = 0; i < segs.size(); i++) sampled[i] = city.isPathClear(segs[i].start, segs[i].end);
+        double sampledMs = sw.elapsedMs();
+        sw.restart();
+        for (size_t i = 0; i < segs.size(); i++) exact[i] = city.isSegmentClear(segs[i].start, segs[i].end);
+        double exactMs = sw.elapsedMs();
+        city.setSpatialIndexEnabled(false);
+        sw.restart();
+        for (size_t i = 0; i < segs.size(); i++) {
+            if (city.isSegmentClear(segs[i].start, segs[i].end) != (bool)exact[i]) mismatch++;
+        }
+        double linearMs = sw.elapsedMs();
+        for (size_t i = 0; i < segs.size(); i++) {
+            if (sampled[i] && !exact[i]) tunneled++;
+        }
+
+        cout << fixed << setprecision(2) << left << setw(12) << n
+             << setw(14) << sampledMs * 1000 / segments
+             << setw(14) << exactMs * 1000 / segments
+             << setw(16) << linearMs * 1000 / segments
+             << tunneled << (mismatch ? "  INDEX MISMATCH" : "") << "\n";
+    }
+}
+
+// voxel bitmap: bake cost, memory footprint, incremental update and planner speedup
+inline void benchOccupancy(const Map3D& baseMap) {
+    StreamStateGuard streamState;
+    cout << "\nOccupancy bitmap (" << baseMap.getName() << ")\n";
+    Map3D baked = baseMap;
+    Stopwatch sw;
+    baked.bakeOccupancy(1.0, 0.5);
+    cout << fixed << setprecision(3);
+    cout << "  Bake: " << sw.elapsedMs() << " ms, " << baked.getOccupancy().getMemoryBytes() << " bytes\n";
+
+    auto queries = makeRandomQueries(baseMap, 50);
+    GridPathFinder floatChecks(&baseMap, 1.0);
+    GridPathFinder bitTests(&baked, 1.0);
+    benchPathFinderAB(baseMap, floatChecks, "Box checks", bitTests, "Bit tests", queries);
+
+    cout << "\nSizing for large maps (resolution 1.0)\n";
+    cout << "  1000x1000x200 estimate: " << VoxelGrid::estimateBytes(1000, 1000, 200, 1.0) / (1024.0 * 1024.0)
+         << " MB\n";
+    Map3D city = makeRandomCity(1000, 1000, 200, 5000);
+    sw.restart();
+    city.bakeOccupancy(1.0, 0.5);
+    double fullMs = sw.elapsedMs();
+    cout << "  Full bake, 5000 buildings: " << fullMs << " ms, "
+         << city.getOccupancy().getMemoryBytes() / (1024.0 * 1024.0) << " MB\n";
+    sw.restart();
+    city.addObstacle(Obstacle(Vector3D(500, 500, 0), 5, 5, 40, "New Tower"));
+    cout << "  Incremental add of one obstacle: " << sw.elapsedMs() << " ms\n";
+}
+
+// synthetic mission records: a fleet of drones, one mission every 30 seconds
+inline vector<MissionResult> makeSyntheticMissions(int count, int fleetSize = 50, unsigned seed = 3, int routes = 0) {
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pick(0, fleetSize - 1), coord(0, 49), alt(1, 19);
+    uniform_real_distribution<double> dist(5, 120);
+    time_t t0 = parseTimestamp("2025-01-01 00:00:00");
+    // routes > 0: missions fly a fixed set of start/end pairs, busiest first
+    mt19937 routeRng(seed + 1);
+    uniform_real_distribution<double> skew(0, 1);
+    vector<pair<string, string>> routeTable;
+    for (int r = 0; r < routes; r++) {
+        routeTable.push_back(make_pair(
+            "(" + to_string(coord(routeRng)) + "," + to_string(coord(routeRng)) + "," + to_string(alt(routeRng)) + ")",
+            "(" + to_string(coord(routeRng)) + "," + to_string(coord(routeRng)) + "," + to_string(alt(routeRng)) + ")"));
+    }
+    vector<MissionResult> missions(count);
+    for (int i = 0; i < count; i++) {
+        MissionResult& m = missions[i];
+        char id[16];
+        snprintf(id, sizeof(id), "DRN-%03d", pick(rng));
+        m.droneId = id;
+        if (routes > 0) {
+            double u = skew(routeRng);
+            const pair<string, string>& route = routeTable[min(routes - 1, (int)(u * u * routes))];
+            m.startPos = route.first;
+            m.endPos = route.second;
+        } else {
+            m.startPos = "(" + to_string(coord(rng)) + "," + to_string(coord(rng)) + "," + to_string(alt(rng)) + ")";
+            m.endPos = "(" + to_string(coord(rng)) + "," + to_string(coord(rng)) + "," + to_string(alt(rng)) + ")";
+        }
+        m.distance = (int)(dist(rng) * 100) / 100.0;
+        m.batteryUsed = (int)(m.distance * 50) / 100.0;
+        m.duration = m.batteryUsed;
+        m.status = (i % 17 == 0) ? "Emergency Landing" : "Completed";
+        m.timestamp = formatTimestamp(t0 + (time_t)i * 30);
+    }
+    return missions;
+}
+
+inline size_t fileBytes(const string& path) {
+    ifstream f(path, ios::binary | ios::ate);
+    return f.is_open() ? (size_t)f.tellg() : 0;
+}
+
+// summary aggregation: parse every CSV row vs scan mapped columns
+inline void benchMissionLog(int rows = 500000) {
+    StreamStateGuard streamState;
+    const string csvPath = "bench_missions.csv", base = "bench_missions";
+    cout << "\nMission log summary scan (" << rows << " rows)\n";
+    auto missions = makeSyntheticMissions(rows);
+    {
+        ofstream csv(csvPath, ios::trunc);
+        for (const auto& m : missions) csv << m.toCSV() << '\n';
+    }
+    Stopwatch sw;
+    size_t imported = importMissionCSV(csvPath, base, true);
+    double importMs = sw.elapsedMs();
+
+    // legacy path: getline + fromCSV per row, then aggregate
+    sw.restart();
+    double csvDist = 0;
+    int csvDone = 0;
+    {
+        ifstream in(csvPath);
+        string line;
+        while (getline(in, line)) {
+            if (line.empty()) continue;
+            MissionResult m = MissionResult::fromCSV(line);
+            csvDist += m.distance;
+            if (m.status == "Completed") csvDone++;
+        }
+    }
+    double csvMs = sw.elapsedMs();
+
+    sw.restart();
+    double colDist = 0;
+    int colDone = 0;
+    ColumnarLogReader reader(base);
+    long completed = reader.getStatuses().find("Completed");
+    const double* dist = reader.distances();
+    const uint8_t* status = reader.statusIds();
+    for (size_t i = 0; i < reader.size(); i++) {
+        colDist += dist[i];
+        if (status[i] == completed) colDone++;
+    }
+    double colMs = sw.elapsedMs();
+
+    size_t colBytes = fileBytes(base + ".dict");
+    for (const auto& spec : kMissionColumns) colBytes += fileBytes(base + spec.suffix);
+
+    cout << fixed << setprecision(1);
+    cout << "  CSV import into columns: " << importMs << " ms (" << imported << " rows)\n";
+    cout << "  CSV parse + aggregate:   " << csvMs << " ms, " << fileBytes(csvPath) / 1024 << " KB\n";
+    cout << "  Column scan (mmap):      " << setprecision(2) << colMs << " ms, "
+         << colBytes / 1024 << " KB  (" << setprecision(0) << (colMs > 0 ? csvMs / colMs : 0) << "x)\n";
+    cout << "  Totals match: " << ((fabs(csvDist - colDist) < 1e-6 * max(1.0, csvDist) && csvDone == colDone) ? "yes" : "NO")
+         << "\n";
+
+    remove(csvPath.c_str());
+    remove((base + ".dict").c_str());
+    for (const auto& spec : kMissionColumns) remove((base + spec.suffix).c_str());
+}
+
+// logMission cost: open/append/close per record vs buffered writer policies
+inline void benchMissionWriter(int records = 20000) {
+    StreamStateGuard streamState;
+    const string csvPath = "bench_writer.csv", base = "bench_writer";
+    auto missions = makeSyntheticMissions(records);
+    cout << "\nMission log writes (" << records << " records)\n";
+    cout << left << setw(34) << "Writer" << setw(16) << "Caller us/rec" << "Total ms (incl. barrier)\n";
+    cout << string(74, '-') << "\n";
+    cout << fixed << setprecision(2);
+
+    // the old logMission: open, write one line with endl, close
+    {
+        Stopwatch sw;
+        for (const auto& m : missions) {
+            ofstream file(csvPath, ios::app);
+            file << m.toCSV() << endl;
+        }
+        double ms = sw.elapsedMs();
+        cout << left << setw(34) << "CSV open/append/close" << setw(16) << ms * 1000 / records << ms << "\n";
+        remove(csvPath.c_str());
+    }
+
+    struct Variant {
+        const char* name;
+        FlushPolicy policy;
+        bool background;
+    };
+    const Variant variants[] = {
+        {"Columnar, flush every record", FlushPolicy::everyRecord(), false},
+        {"Columnar, batched inline", FlushPolicy(), false},
+        {"Columnar, batched writer thread", FlushPolicy(), true},
+    };
+    for (const auto& v : variants) {
+        size_t rows;
+        double callerMs, totalMs;
+        {
+            BufferedMissionWriter writer(v.policy, v.background);
+            writer.open(base, true);
+            Stopwatch sw;
+            for (const auto& m : missions) writer.append(m);
+            callerMs = sw.elapsedMs();
+            writer.flush();
+            totalMs = sw.elapsedMs();
+        }
+        rows = ColumnarLogReader(base).size();
+        cout << left << setw(34) << v.name << setw(16) << callerMs * 1000 / records << totalMs
+             << (rows != (size_t)records ? "  ROWS MISSING" : "") << "\n";
+    }
+    remove((base + ".dict").c_str());
+    for (const auto& spec : kMissionColumns) remove((base + spec.suffix).c_str());
+}
+
+// summary figures: recount the whole log vs running aggregates + snapshot
+inline void benchMissionStats(int rows = 500000) {
+    StreamStateGuard streamState;
+    const string base = "bench_stats";
+    auto missions = makeSyntheticMissions(rows);
+    {
+        ColumnarLogWriter writer;
+        writer.open(base, true);
+        for (const auto& m : missions) writer.append(m);
+    }
+    cout << "\nMission statistics (" << rows << " logged missions)\n";
+    cout << fixed << setprecision(3);
+
+    Stopwatch sw;
+    MissionStats rebuilt;
+    {
+        ColumnarLogReader reader(base);
+        rebuilt.rebuild(reader);
+    }
+    double rebuildMs = sw.elapsedMs();
+
+    MissionStats running;
+    sw.restart();
+    for (const auto& m : missions) running.add(m);
+    double addNs = sw.elapsedMs() * 1e6 / rows;
+
+    sw.restart();
+    running.save(base + ".stats");
+    double saveMs = sw.elapsedMs();
+    MissionStats loaded;
+    sw.restart();
+    loaded.load(base + ".stats");
+    double loadMs = sw.elapsedMs();
+
+    bool same = loaded.rowCount() == rebuilt.rowCount() &&
+                fabs(loaded.getTotalDistance() - rebuilt.getTotalDistance()) < 1e-6 * rebuilt.getTotalDistance() &&
+                loaded.getDrones().size() == rebuilt.getDrones().size();
+    cout << "  Full recount from columns: " << rebuildMs << " ms\n";
+    cout << "  Incremental update:        " << setprecision(1) << addNs << " ns per logMission\n";
+    cout << setprecision(3);
+    cout << "  Snapshot save / load:      " << saveMs << " ms / " << loadMs << " ms, "
+         << fileBytes(base + ".stats") << " bytes\n";
+    cout << "  Snapshot matches recount:  " << (same ? "yes" : "NO") << "\n";
+
+    remove((base + ".stats").c_str());
+    remove((base + ".dict").c_str());
+    for (const auto& spec : kMissionColumns) remove((base + spec.suffix).c_str());
+}
+
+// the tokenizing fromCSV this repo used before MissionCSV.h, kept for comparison
+inline MissionResult legacyFromCSV(const string& line) {
+    MissionResult result;
+    vector<string> tokens;
+    string token;
+    int depth = 0;
+    for (char c : line) {
+        if (c == '(') depth++;
+        else if (c == ')' && depth > 0) depth--;
+        if (c == ',' && depth == 0) {
+            tokens.push_back(token);
+            token.clear();
+        } else if (c != '\r') {
+            token += c;
+        }
+    }
+    tokens.push_back(token);
+    if (tokens.size() >= 8) {
+        result.droneId = tokens[0];
+        result.startPos = tokens[1];
+        result.endPos = tokens[2];
+        result.distance = atof(tokens[3].c_str());
+        result.batteryUsed = atof(tokens[4].c_str());
+        result.duration = atof(tokens[5].c_str());
+        result.status = tokens[6];
+        result.timestamp = tokens[7];
+    }
+    return result;
+}
+
+// CSV row parsing throughput: tokenizer vs parseCSV vs chunked zero-copy scanner
+inline void benchCSVParse(int rows = 500000) {
+    StreamStateGuard streamState;
+    const string csvPath = "bench_parse.csv";
+    const int kBroken = 5;
+    auto missions = makeSyntheticMissions(rows);
+    {
+        ofstream csv(csvPath, ios::trunc);
+        for (int i = 0; i < rows; i++) {
+            csv << missions[i].toCSV() << '\n';
+            // a few damaged rows spread through the file
+            if (i % (rows / kBroken + 1) == 0) csv << "DRN-001,(1,2,3),(4,5,6),12.5,oops,1.0,Completed\n";
+        }
+    }
+    double mb = fileBytes(csvPath) / (1024.0 * 1024.0);
+    cout << "\nMission CSV parsing (" << rows << " rows + " << kBroken << " malformed, "
+         << fixed << setprecision(1) << mb << " MB)\n";
+    cout << left << setw(30) << "Parser" << setw(12) << "ms" << setw(14) << "Mrows/s" << setw(10) << "MB/s"
+         << "Rejected\n";
+    cout << string(74, '-') << "\n";
+    auto report = [&](const char* name, double ms, size_t parsed, size_t rejected) {
+        cout << left << setw(30) << name << setw(12) << setprecision(1) << ms << setw(14) << setprecision(2)
+             << parsed / (ms * 1000) << setw(10) << setprecision(0) << mb * 1000 / ms << rejected << "\n";
+    };
+
+    double sums[3] = {0, 0, 0};
+    Stopwatch sw;
+    {
+        ifstream in(csvPath);
+        string line;
+        size_t parsed = 0, rejected = 0;
+        while (getline(in, line)) {
+            if (line.empty()) continue;
+            MissionResult m = legacyFromCSV(line);
+            // the tokenizer only notices rows short of fields; bad numbers become 0
+            if (m.droneId.empty()) rejected++;
+            sums[0] += m.distance + m.batteryUsed;
+            parsed++;
+        }
+        report("getline + tokenizer + atof", sw.elapsedMs(), parsed, rejected);
+    }
+
+    sw.restart();
+    {
+        ifstream in(csvPath);
+        string line;
+        MissionResult m;
+        size_t parsed = 0, rejected = 0;
+        while (getline(in, line)) {
+            if (line.empty()) continue;
+            if (!MissionResult::parseCSV(line, m)) {
+                rejected++;
+                continue;
+            }
+            sums[1] += m.distance + m.batteryUsed;
+            parsed++;
+        }
+        report("getline + parseCSV", sw.elapsedMs(), parsed, rejected);
+    }
+
+    sw.restart();
+    {
+        MissionCSVScanner scanner;
+        scanner.open(csvPath);
+        scanner.scan([&](const MissionRecordView& v) { sums[2] += v.distance + v.batteryUsed; });
+        report("Chunked zero-copy scanner", sw.elapsedMs(), scanner.getReport().rows, scanner.getReport().malformed);
+        if (!scanner.getReport().issues.empty()) {
+            const CSVIssue& first = scanner.getReport().issues[0];
+            cout << "  First rejected row: line " << first.line << ", field " << first.field + 1 << " ("
+                 << csvErrorName(first.error) << ")\n";
+        }
+    }
+    // the tokenizer also sums the damaged rows' fields, so compare the two strict parsers
+    cout << "  Scanner matches parseCSV: " << (fabs(sums[1] - sums[2]) < 1e-6 * max(1.0, sums[1]) ? "yes" : "NO")
+         << "\n";
+    remove(csvPath.c_str());
+}
+
+// group-by analytics: thread scaling, and sketch quantiles vs exact ones
+inline void benchMissionAnalytics(int rows = 2000000, int routes = 5000) {
+    StreamStateGuard streamState;
+    const string base = "bench_analytics";
+    auto missions = makeSyntheticMissions(rows, 50, 3, routes);
+    {
+        ColumnarLogWriter writer;
+        writer.open(base, true);
+        for (const auto& m : missions) writer.append(m);
+    }
+    ColumnarLogReader reader(base);
+    cout << "\nMission analytics (" << rows << " missions over " << routes << " routes)\n";
+    cout << left << setw(10) << "Threads" << setw(14) << "By drone ms" << setw(14) << "By day ms"
+         << "By route ms\n";
+    cout << string(50, '-') << "\n";
+    cout << fixed << setprecision(1);
+    int hw = max(1, (int)thread::hardware_concurrency());
+    vector<GroupResult> drones;
+    for (int threads = 1; threads <= hw; threads *= 2) {
+        MissionAnalytics analytics(threads);
+        Stopwatch sw;
+        drones = analytics.byDrone(reader);
+        double droneMs = sw.elapsedMs();
+        sw.restart();
+        size_t days = analytics.byTime(reader).size();
+        double dayMs = sw.elapsedMs();
+        sw.restart();
+        analytics.byRoute(reader, 20);
+        size_t routes = analytics.getGroupCount();
+        double routeMs = sw.elapsedMs();
+        cout << left << setw(10) << threads << setw(14) << droneMs << setw(14) << dayMs << routeMs << "\n";
+        if (threads * 2 > hw) {
+            cout << "  Groups: " << drones.size() << " drones, " << days << " days, " << routes << " routes\n";
+        }
+    }
+
+    // the old approach: every sample per drone, sorted for exact quantiles
+    Stopwatch sw;
+    unordered_map<string, vector<double>> samples;
+    for (size_t i = 0; i < reader.size(); i++) {
+        samples[reader.getDrones().name(reader.droneIds()[i])].push_back(reader.distances()[i]);
+    }
+    double worst = 0;
+    size_t sampleBytes = 0, sketchBytes = 0;
+    for (const auto& g : drones) {
+        vector<double>& v = samples[g.key];
+        sampleBytes += v.capacity() * sizeof(double);
+        sketchBytes += g.stats.distance.sketch.memoryBytes();
+        sort(v.begin(), v.end());
+        for (double q : {0.5, 0.9, 0.99}) {
+            double exact = v[(size_t)(q * (v.size() - 1) + 0.5)];
+            if (exact > 0) worst = max(worst, fabs(g.stats.distance.quantile(q) - exact) / exact);
+        }
+    }
+    double exactMs = sw.elapsedMs();
+    cout << "  Exact per-drone quantiles (store + sort): " << exactMs << " ms, " << sampleBytes / 1024 << " KB\n";
+    cout << "  Sketch: " << sketchBytes / 1024 << " KB, worst p50/p90/p99 error " << setprecision(3)
+         << worst * 100 << "%\n";
+
+    remove((base + ".dict").c_str());
+    for (const auto& spec : kMissionColumns) remove((base + spec.suffix).c_str());
+}
+
+// path length as computed before distanceTo dropped pow()
+inline double legacyPathLength(const vector<Vector3D>& path) {
+    double total = 0;
+    for (size_t i = 1; i < path.size(); i++) {
+        const Vector3D& a = path[i - 1];
+        const Vector3D& b = path[i];
+        total += sqrt(pow(a.getX() - b.getX(), 2) + pow(a.getY() - b.getY(), 2) + pow(a.getZ() - b.getZ(), 2));
+    }
+    return total;
+}
+
+// path kernels: AoS vector<Vector3D> vs SoA scalar vs SoA AVX2
+inline void benchPathKernels(int pathCount = 2000, int waypoints = 500, int reps = 20) {
+    StreamStateGuard streamState;
+    mt19937 rng(11);
+    uniform_real_distribution<double> step(-1.5, 1.5);
+    vector<vector<Vector3D>> paths(pathCount);
+    vector<PathSoA> soa(pathCount);
+    for (int p = 0; p < pathCount; p++) {
+        Vector3D at(25, 12, 5);
+        for (int w = 0; w < waypoints; w++) {
+            at = at + Vector3D(step(rng), step(rng), step(rng) * 0.3);
+            paths[p].push_back(at);
+        }
+        soa[p].assign(paths[p]);
+    }
+    double segments = (double)pathCount * (waypoints - 1) * reps;
+    const PathKernelTable& best = detectPathKernels();
+    const PathKernelTable& scalar = scalarPathKernels();
+    const PathKernelTable* original = activePathKernels();
+
+    cout << "\nPath kernels (" << pathCount << " paths x " << waypoints << " waypoints, best: " << best.name
+         << ")\n";
+    cout << left << setw(34) << "Total length" << setw(12) << "ns/seg" << "Speedup\n";
+    cout << string(54, '-') << "\n";
+    double baseNs = 0, reference = 0, worstDiff = 0;
+    auto row = [&](const char* name, double ms, double total) {
+        double ns = ms * 1e6 / segments;
+        if (baseNs == 0) {
+            baseNs = ns;
+            reference = total;
+        }
+        worstDiff = max(worstDiff, fabs(total - reference) / reference);
+        cout << left << setw(34) << name << setw(12) << fixed << setprecision(2) << ns << setprecision(1)
+             << baseNs / ns << "x\n";
+    };
+
+    Stopwatch sw;
+    double total = 0;
+    for (int r = 0; r < reps; r++) for (const auto& p : paths) total += legacyPathLength(p);
+    row("AoS, pow() per component", sw.elapsedMs(), total);
+
+    sw.restart();
+    total = 0;
+    for (int r = 0; r < reps; r++) for (const auto& p : paths) total += pathLength(p);
+    row("AoS, pathLength", sw.elapsedMs(), total);
+
+    const PathKernelTable* tables[2] = {&scalar, &best};
+    for (int t = 0; t < (&best == &scalar ? 1 : 2); t++) {
+        setPathKernels(*tables[t]);
+        sw.restart();
+        total = 0;
+        for (int r = 0; r < reps; r++) for (const auto& p : soa) total += soaPathLength(p);
+        row(t == 0 ? "SoA, scalar kernel" : "SoA, AVX2 kernel", sw.elapsedMs(), total);
+    }
+    cout << "  Largest difference between totals: " << scientific << setprecision(1) << worstDiff << fixed
+         << " (relative)\n";
+
+    // the remaining kernels, scalar vs best
+    cout << "\n" << left << setw(34) << "Kernel (ms)" << setw(12) << "scalar" << best.name << "\n";
+    cout << string(54, '-') << "\n";
+    vector<double> out(waypoints), charge;
+    const char* names[4] = {"Segment lengths", "Cumulative arc length", "Bounding box", "Battery along path"};
+    for (int k = 0; k < 4; k++) {
+        double ms[2] = {0, 0};
+        double check[2] = {0, 0};
+        for (int t = 0; t < 2; t++) {
+            setPathKernels(*tables[t]);
+            sw.restart();
+            for (int r = 0; r < reps; r++) {
+                for (const auto& p : soa) {
+                    const PathKernelTable& K = *activePathKernels();
+                    if (k == 0) {
+                        K.segments(p.x(), p.y(), p.z(), p.size(), out.data());
+                        check[t] += out[p.size() / 2];
+                    } else if (k == 1) {
+                        K.cumulative(p.x(), p.y(), p.z(), p.size(), out.data());
+                        check[t] += out[p.size() - 1];
+                    } else if (k == 2) {
+                        PathBounds b = soaBounds(p);
+                        check[t] += b.hi.getX() - b.lo.getZ();
+                    } else {
+                        check[t] += (double)soaBatteryAlongPath(p, 100, 0.5, 10, charge);
+                    }
+                }
+            }
+            ms[t] = sw.elapsedMs();
+        }
+        bool agree = fabs(check[0] - check[1]) <= 1e-9 * max(1.0, fabs(check[0]));
+        cout << left << setw(34) << names[k] << setw(12) << setprecision(1) << ms[0] << ms[1]
+             << (agree ? "" : "  (results differ!)") << "\n";
+    }
+    setPathKernels(*original);
+}
+
+// path cache: store/lookup cost, real memory and accuracy per waypoint encoding
+inline void benchPathCacheEncoding(int paths = 20000) {
+    StreamStateGuard streamState;
+    mt19937 rng(21);
+    uniform_int_distribution<int> cell(0, 99), height(1, 30), len(5, 60), step(-1, 1);
+    vector<pair<Vector3D, Vector3D>> routes(paths);
+    vector<vector<Vector3D>> stored(paths);
+    size_t waypoints = 0;
+    for (int i = 0; i < paths; i++) {
+        // lattice walk from a non-integer start, as the planner produces
+        Vector3D at(cell(rng) + 0.25, cell(rng) + 0.5, height(rng));
+        routes[i].first = at;
+        int n = len(rng);
+        for (int w = 0; w < n; w++) {
+            stored[i].push_back(at);
+            at = at + Vector3D(step(rng), step(rng), step(rng));
+        }
+        // the query end is rarely on the lattice
+        stored[i].back() = stored[i].back() + Vector3D(0.37, -0.11, 0.05);
+        routes[i].second = stored[i].back();
+        waypoints += n;
+    }
+    cout << "\nPath cache encodings (" << paths << " paths, " << waypoints << " waypoints)\n";
+    cout << left << setw(10) << "Encoding" << setw(12) << "Store ns" << setw(13) << "Lookup ns"
+         << setw(13) << "Heap KB" << setw(13) << "B/waypoint" << "Max error\n";
+    cout << string(72, '-') << "\n";
+    const WaypointEncoding encodings[] = {WAYPOINT_DOUBLE, WAYPOINT_FLOAT, WAYPOINT_INT16};
+    vector<Vector3D> out;
+    for (WaypointEncoding enc : encodings) {
+        PathCache cache(256 * 1024 * 1024, 0.01, enc);
+        Stopwatch sw;
+        for (int i = 0; i < paths; i++) cache.store(routes[i].first, routes[i].second, stored[i], 0);
+        double storeNs = sw.elapsedMs() * 1e6 / paths;
+        double worst = 0;
+        sw.restart();
+        for (int i = 0; i < paths; i++) cache.lookup(routes[i].first, routes[i].second, out);
+        double lookupNs = sw.elapsedMs() * 1e6 / paths;
+        for (int i = 0; i < paths; i++) {
+            cache.lookup(routes[i].first, routes[i].second, out);
+            for (size_t w = 0; w < out.size(); w++) worst = max(worst, out[w].distanceTo(stored[i][w]));
+        }
+        size_t heap = cache.memoryBytes();
+        cout << left << setw(10) << waypointEncodingName(enc) << setw(12) << fixed << setprecision(0) << storeNs
+             << setw(13) << lookupNs << setw(13) << heap / 1024 << setw(13) << setprecision(1)
+             << (double)heap / waypoints << scientific << setprecision(1) << worst << fixed << "\n";
+    }
+
+    // churn: a small budget forces evictions, holes and arena compaction
+    PathCache small(512 * 1024);
+    Stopwatch sw;
+    for (int r = 0; r < 5; r++) {
+        for (int i = 0; i < paths; i++) small.store(routes[i].first, routes[i].second, stored[i], 0);
+    }
+    double churnNs = sw.elapsedMs() * 1e6 / (5.0 * paths);
+    cout << "\nEviction churn (512 KB budget, " << 5 * paths << " stores): " << setprecision(0) << churnNs
+         << " ns/store, heap " << small.memoryBytes() / 1024 << " KB\n";
+    small.printStats();
+}
+
+// HPA* on a map 100x the area of Metro City, where flat A* runs out of iterations
+inline void benchHierarchical(int queryCount = 20) {
+    StreamStateGuard streamState;
+    Map3D city = makeRandomCity(500, 250, 20, 2000);
+    auto queries = makeRandomQueries(city, queryCount);
+    cout << "\nHierarchical planning on " << city.getWidth() << "x" << city.getDepth() << "x" << city.getHeight()
+         << " (" << city.getObstacles().size() << " buildings, " << queries.size() << " queries)\n";
+
+    // the reference: flat A* allowed to finish
+    GridPathFinder exact(&city, 1.0);
+    exact.setMaxIterations(numeric_limits<int>::max());
+    GridPathFinder capped(&city, 1.0);
+    vector<double> exactLength(queries.size());
+    double exactMs = 0, cappedMs = 0, cappedLength = 0;
+    int fallbacks = 0;
+    for (size_t q = 0; q < queries.size(); q++) {
+        Stopwatch sw;
+        exactLength[q] = pathLength(exact.findPath(queries[q].start, queries[q].end));
+        exactMs += sw.elapsedMs();
+        sw.restart();
+        auto path = capped.findPath(queries[q].start, queries[q].end);
+        cappedMs += sw.elapsedMs();
+        cappedLength += pathLength(path);
+        if (path == safeAltitudePath(&city, queries[q].start, queries[q].end)) fallbacks++;
+    }
+    double exactTotal = 0;
+    for (double l : exactLength) exactTotal += l;
+    size_t n = max<size_t>(1, queries.size());
+
+    cout << left << setw(24) << "Planner" << setw(11) << "Build ms" << setw(11) << "ms/query"
+         << setw(13) << "Length/A*" << "Notes\n";
+    cout << string(78, '-') << "\n";
+    cout << fixed << setprecision(2);
+    cout << left << setw(24) << "A* (no limit)" << setw(11) << "-" << setw(11) << exactMs / n
+         << setw(13) << "1.000" << "reference\n";
+    cout << left << setw(24) << "A* (10000 iterations)" << setw(11) << "-" << setw(11) << cappedMs / n
+         << setw(13) << setprecision(3) << cappedLength / exactTotal << setprecision(2) << fallbacks << " safe-altitude fallbacks\n";
+
+    struct Config {
+        const char* name;
+        int clusterCells, spacing;
+    };
+    const Config configs[] = {{"HPA* 16, spacing 8", 16, 8}, {"HPA* 16, spacing 16", 16, 16}};
+    for (const Config& c : configs) {
+        HierarchicalPathFinder hpa(&city, 1.0, c.clusterCells, 0, c.spacing, (int)thread::hardware_concurrency());
+        hpa.build();
+        const HierarchyStats& h = hpa.getHierarchyStats();
+        double ms = 0, length = 0;
+        for (const auto& q : queries) {
+            Stopwatch sw;
+            length += pathLength(hpa.findPath(q.start, q.end));
+            ms += sw.elapsedMs();
+        }
+        cout << left << setw(24) << c.name << setw(11) << h.buildMs << setw(11) << ms / n << setw(13)
+             << setprecision(3) << length / exactTotal << setprecision(2) << h.entrances << " entrances, " << h.memoryBytes / 1024 << " KB\n";
+        double saved = (exactMs - ms) / n;
+        if (saved > 0) {
+            cout << "  build repaid after " << setprecision(0) << ceil(h.buildMs / saved)
+                 << " queries vs A* (no limit)\n" << setprecision(2);
+        }
+    }
+}
+
+// heap traffic of one search: inserts, in-place updates and pops
+inline long heapOperations(const SearchStats& s) {
+    return s.pushes + s.decreaseKeys + s.expansions + s.stalePops;
+}
+
+// JPS vs flat A* on the same lattice: open-set traffic, time, and whether the
+// lattice path costs agree (the repo has no test suite, so the parity check
+// lives here)
+inline void benchJumpPoint(const Map3D& map, int queryCount = 50) {
+    StreamStateGuard streamState;
+    struct Scenario {
+        string name;
+        Map3D city;
+        int maxZ;
+    };
+    vector<Scenario> scenarios;
+    scenarios.push_back({map.getName(), map, 6});
+    scenarios.push_back({"Sparse 150x150x40", makeRandomCity(150, 150, 40, 150), 30});
+
+    cout << "\nJump point search vs A* (" << queryCount << " queries per map, no iteration limit)\n";
+    cout << left << setw(22) << "Map" << setw(18) << "Planner" << setw(13) << "Expansions"
+         << setw(12) << "Heap ops" << setw(13) << "Scanned" << setw(10) << "ms" << "Cost match\n";
+    cout << string(98, '-') << "\n";
+    cout << fixed << setprecision(2);
+    for (Scenario& sc : scenarios) {
+        auto queries = makeRandomQueries(sc.city, queryCount, 5, sc.maxZ);
+        PathFinder3D indexed(&sc.city, 1.0);
+        indexed.setCacheBudget(0);
+        indexed.setMaxIterations(numeric_limits<int>::max());
+        GridPathFinder grid(&sc.city, 1.0);
+        grid.setMaxIterations(numeric_limits<int>::max());
+        JumpPointFinder jps(&sc.city, 1.0);
+        jps.setMaxIterations(numeric_limits<int>::max());
+
+        SearchStats totals[3];
+        double ms[3] = {0, 0, 0};
+        long scanned = 0;
+        int matches = 0;
+        for (const auto& q : queries) {
+            Stopwatch sw;
+            indexed.findPath(q.start, q.end);
+            ms[0] += sw.elapsedMs();
+            sw.restart();
+            grid.findPath(q.start, q.end);
+            ms[1] += sw.elapsedMs();
+            sw.restart();
+            jps.findPath(q.start, q.end);
+            ms[2] += sw.elapsedMs();
+            totals[0].add(indexed.getLastStats());
+            totals[1].add(grid.getLastStats());
+            totals[2].add(jps.getLastStats());
+            scanned += jps.getLastScanned();
+            if (fabs(jps.getLastStats().pathCost - grid.getLastStats().pathCost) < 1e-6) matches++;
+        }
+        const char* names[] = {"PathFinder3D", "GridPathFinder", "JumpPointFinder"};
+        for (int p = 0; p < 3; p++) {
+            cout << left << setw(22) << (p == 0 ? sc.name : "") << setw(18) << names[p]
+                 << setw(13) << totals[p].expansions << setw(12) << heapOperations(totals[p])
+                 << setw(13) << (p == 2 ? to_string(scanned) : "-") << setw(10) << ms[p];
+            if (p == 2) cout << matches << "/" << queries.size();
+            cout << "\n";
+        }
+        cout << "  heap ops saved vs GridPathFinder: " << (double)heapOperations(totals[1]) / max(1L, heapOperations(totals[2]))
+             << "x, time " << ms[1] / max(1e-9, ms[2]) << "x\n";
+    }
+
+    // parity sweep: small random cities, half of them baked, off-lattice goals
+    int total = 0, equal = 0;
+    double worst = 0;
+    for (unsigned seed = 1; seed <= 8; seed++) {
+        Map3D city = makeRandomCity(60, 40, 20, 40 + seed * 10, seed);
+        if (seed % 2) city.bakeOccupancy(1.0, 0.5);
+        GridPathFinder grid(&city, 1.0);
+        grid.setMaxIterations(numeric_limits<int>::max());
+        JumpPointFinder jps(&city, 1.0);
+        jps.setMaxIterations(numeric_limits<int>::max());
+        for (const auto& q : makeRandomQueries(city, 40, seed, 15)) {
+            grid.findPath(q.start, q.end);
+            jps.findPath(q.start, q.end);
+            double diff = fabs(jps.getLastStats().pathCost - grid.getLastStats().pathCost);
+            total++;
+            if (diff < 1e-6) equal++;
+            worst = max(worst, diff);
+        }
+    }
+    cout << "\nCost parity on 8 random 60x40x20 cities: " << equal << "/" << total
+         << " equal to A*, worst difference " << setprecision(6) << worst << "\n";
+}
+
+// Lazy Theta* vs A* followed by smoothPathOnMap: line-of-sight tests, time
+// and the length of the returned path
+inline void benchThetaStar(const Map3D& map, int queryCount = 50) {
+    StreamStateGuard streamState;
+    struct Scenario {
+        string name;
+        Map3D city;
+        int maxZ;
+    };
+    vector<Scenario> scenarios;
+    scenarios.push_back({map.getName(), map, 6});
+    scenarios.push_back({"Sparse 150x150x40", makeRandomCity(150, 150, 40, 150), 30});
+
+    cout << "\nAny-angle search vs A* + smoothing (" << queryCount << " queries per map, no iteration limit)\n";
+    cout << left << setw(22) << "Map" << setw(25) << "Planner" << setw(12) << "ms/query" << setw(12) << "LOS/query"
+         << setw(12) << "Exp/query" << setw(11) << "Waypoints" << "Length/A*\n";
+    cout << string(104, '-') << "\n";
+    cout << fixed << setprecision(2);
+    for (Scenario& sc : scenarios) {
+        auto queries = makeRandomQueries(sc.city, queryCount, 5, sc.maxZ);
+        PathFinder3D indexed(&sc.city, 1.0);
+        indexed.setCacheBudget(0);
+        indexed.setMaxIterations(numeric_limits<int>::max());
+        GridPathFinder grid(&sc.city, 1.0);
+        grid.setMaxIterations(numeric_limits<int>::max());
+        ThetaStarFinder theta(&sc.city, 1.0);
+        theta.setMaxIterations(numeric_limits<int>::max());
+
+        const char* names[] = {"PathFinder3D + smooth", "GridPathFinder + smooth", "Lazy Theta*"};
+        SearchStats totals[3];
+        double ms[3] = {0, 0, 0}, length[3] = {0, 0, 0};
+        size_t waypoints[3] = {0, 0, 0};
+        for (const auto& q : queries) {
+            for (int p = 0; p < 3; p++) {
+                Stopwatch sw;
+                vector<Vector3D> path = p == 0 ? indexed.findPath(q.start, q.end)
+                                      : p == 1 ? grid.findPath(q.start, q.end)
+                                               : theta.findPath(q.start, q.end);
+                ms[p] += sw.elapsedMs();
+                totals[p].add(p == 0 ? indexed.getLastStats() : p == 1 ? grid.getLastStats() : theta.getLastStats());
+                length[p] += pathLength(path);
+                waypoints[p] += path.size();
+            }
+        }
+        double n = (double)max<size_t>(1, queries.size());
+        for (int p = 0; p < 3; p++) {
+            cout << left << setw(22) << (p == 0 ? sc.name : "") << setw(25) << names[p] << setw(12) << ms[p] / n
+                 << setw(12) << totals[p].segmentChecks / n << setw(12) << totals[p].expansions / n
+                 << setw(11) << waypoints[p] / n << setprecision(3) << length[p] / length[1] << setprecision(2) << "\n";
+        }
+    }
+}
+
+// bidirectional A* on long corner-to-corner routes, starting with the quickFlight mission
+inline void benchBidirectional(const Map3D& map, int reps = 5) {
+    StreamStateGuard streamState;
+    struct Route {
+        string name;
+        Map3D city;
+        Vector3D start, end;
+    };
+    vector<Route> routes;
+    routes.push_back({map.getName() + " quickFlight", map, Vector3D(2, 2, 1), Vector3D(45, 20, 2)});
+    routes.push_back({"200x100 city corners", makeRandomCity(200, 100, 20, 400), Vector3D(1, 1, 1), Vector3D(198, 98, 2)});
+    routes.push_back({"300x300 city corners", makeRandomCity(300, 300, 20, 1200), Vector3D(1, 1, 1), Vector3D(298, 298, 2)});
+
+    cout << "\nBidirectional A* (" << reps << " runs per route, no iteration limit, "
+         << thread::hardware_concurrency() << " hardware threads)\n";
+    cout << left << setw(24) << "Route" << setw(26) << "Planner" << setw(12) << "Expanded"
+         << setw(18) << "Forward/backward" << setw(11) << "ms/run" << "Lattice cost\n";
+    cout << string(103, '-') << "\n";
+    for (Route& r : routes) {
+        PathFinder3D current(&r.city, 1.0);
+        current.setCacheBudget(0);
+        current.setMaxIterations(numeric_limits<int>::max());
+        GridPathFinder grid(&r.city, 1.0);
+        grid.setMaxIterations(numeric_limits<int>::max());
+        BidirectionalPathFinder bi(&r.city, 1.0);
+        bi.setMaxIterations(numeric_limits<int>::max());
+        BidirectionalPathFinder bi2(&r.city, 1.0, true);
+        bi2.setMaxIterations(numeric_limits<int>::max());
+
+        IPathFinder* planners[] = {&current, &grid, &bi, &bi2};
+        const char* names[] = {"PathFinder3D (current)", "GridPathFinder", "Bidirectional", "Bidirectional, 2 threads"};
+        for (int p = 0; p < 4; p++) {
+            Stopwatch sw;
+            for (int i = 0; i < reps; i++) planners[p]->findPath(r.start, r.end);
+            double ms = sw.elapsedMs() / max(1, reps);
+            const SearchStats& stats = p == 0 ? current.getLastStats() : p == 1 ? grid.getLastStats()
+                                     : p == 2 ? bi.getLastStats() : bi2.getLastStats();
+            string split = "-";
+            if (p >= 2) {
+                BidirectionalPathFinder& b = p == 2 ? bi : bi2;
+                split = to_string(b.getForwardStats().expansions) + "/" + to_string(b.getBackwardStats().expansions);
+            }
+            cout << left << setw(24) << (p == 0 ? r.name : "") << setw(26) << names[p] << setw(12) << stats.expansions
+                 << setw(18) << split << fixed << setprecision(2) << setw(11) << ms << setprecision(3) << stats.pathCost << "\n";
+        }
+    }
+}
+
+// Pop-up obstacles mid-flight: each mission is flown headless, and at the
+// first long leg a pillar appears halfway along it. D* Lite repairs its
+// mission search; the full replans start from scratch at the same position.
+inline void benchReplanning(const Map3D& map, int missions = 30) {
+    StreamStateGuard streamState;
+    struct Scenario {
+        string name;
+        Map3D city;
+    };
+    vector<Scenario> scenarios;
+    scenarios.push_back({map.getName(), map});
+    scenarios.push_back({"200x100 city", makeRandomCity(200, 100, 20, 400)});
+
+    cout << "\nReplanning after a pop-up obstacle (" << missions << " missions per map, no iteration limit)\n";
+    cout << left << setw(16) << "Map" << setw(24) << "Planner" << setw(10) << "Replans" << setw(13) << "ms/replan"
+         << setw(14) << "Exp/replan" << setw(12) << "Cells hit" << "Cost = A*\n";
+    cout << string(98, '-') << "\n";
+    ConsoleSimulator simulator(make_unique<HeadlessRenderer>());
+    Drone drone("SIM-001", "Benchmark", Battery(1e9, 0.5, "Test"), 2.0);
+
+    for (Scenario& sc : scenarios) {
+        auto queries = makeRandomQueries(sc.city, missions, 17);
+        double initialMs = 0, repairMs = 0, gridMs = 0, classicMs = 0;
+        long repairExp = 0, gridExp = 0, classicExp = 0, cellsHit = 0;
+        int replans = 0, matches = 0;
+        for (const auto& q : queries) {
+            Map3D city = sc.city;
+            DStarLitePathFinder dstar(&city, 1.0);
+            dstar.setMaxIterations(numeric_limits<int>::max());
+            GridPathFinder grid(&city, 1.0);
+            grid.setMaxIterations(numeric_limits<int>::max());
+            PathFinder3D classic(&city, 1.0, 0);
+            classic.setMaxIterations(numeric_limits<int>::max());
+
+            Stopwatch sw;
+            vector<Vector3D> path = dstar.findPath(q.start, q.end);
+            initialMs += sw.elapsedMs();
+            bool dropped = false;
+            simulator.simulateFlight(drone, city, path, q.start, q.end, 0, [&](size_t reached, vector<Vector3D>& route) {
+                if (dropped || reached == 0) return false;
+                Vector3D here = route[reached], next = route[reached + 1];
+                if (here.distanceTo(next) < 6) return false;
+                Vector3D mid = here + (next - here) * 0.5;
+                Obstacle pillar(Vector3D(mid.getX() - 1, mid.getY() - 1, 0), 2, 2, mid.getZ() + 2, "Pop-up");
+                if (pillar.containsPoint(here, 1.5) || pillar.containsPoint(q.end, 1.5)) return false;
+                dropped = true;
+                city.addObstacle(pillar);
+
+                Stopwatch t;
+                route = dstar.replan(here);
+                repairMs += t.elapsedMs();
+                repairExp += dstar.getLastStats().expansions;
+                cellsHit += dstar.getLastChangedCells();
+                t.restart();
+                grid.findPath(here, q.end);
+                gridMs += t.elapsedMs();
+                gridExp += grid.getLastStats().expansions;
+                t.restart();
+                classic.findPath(here, q.end);
+                classicMs += t.elapsedMs();
+                classicExp += classic.getLastStats().expansions;
+                replans++;
+                if (fabs(dstar.getLastStats().pathCost - grid.getLastStats().pathCost) < 1e-6) matches++;
+                return true;
+            });
+        }
+        double n = max(1, replans);
+        cout << fixed << setprecision(3);
+        cout << left << setw(16) << sc.name << setw(24) << "D* Lite (repair)" << setw(10) << replans
+             << setw(13) << repairMs / n << setw(14) << (long)(repairExp / n) << setw(12) << (long)(cellsHit / n)
+             << matches << "/" << replans << "\n";
+        cout << left << setw(16) << "" << setw(24) << "GridPathFinder (full)" << setw(10) << replans
+             << setw(13) << gridMs / n << setw(14) << (long)(gridExp / n) << setw(12) << "-" << "reference\n";
+        cout << left << setw(16) << "" << setw(24) << "PathFinder3D (full)" << setw(10) << replans
+             << setw(13) << classicMs / n << setw(14) << (long)(classicExp / n) << setw(12) << "-" << "-\n";
+        // on small maps a full search is already cheap and the repair loses
+        double speedup = gridMs / max(1e-9, repairMs);
+        cout << "  initial D* Lite plans: " << initialMs / max<size_t>(1, queries.size()) << " ms/mission; repair "
+             << setprecision(1) << (speedup >= 1 ? speedup : 1 / max(1e-9, speedup))
+             << (speedup >= 1 ? "x faster" : "x slower") << " than a full GridPathFinder replan\n";
+    }
+}
+
+// Landmark (ALT) table vs the straight-line heuristic in GridPathFinder:
+// one-off build and load cost, table size, and expansions saved per query
+inline void benchLandmarks(const Map3D& map, int queryCount = 50, int landmarkCount = 8) {
+    StreamStateGuard streamState;
+    struct Scenario {
+        string name;
+        Map3D city;
+        int maxZ;
+    };
+    vector<Scenario> scenarios;
+    scenarios.push_back({map.getName(), map, 6});
+    scenarios.push_back({"200x100 city", makeRandomCity(200, 100, 20, 400), 6});
+    scenarios.push_back({"Sparse 150x150x40", makeRandomCity(150, 150, 40, 150), 30});
+    const string tablePath = "bench_landmarks.alt";
+
+    cout << "\nLandmark heuristic (" << landmarkCount << " landmarks, " << queryCount
+         << " queries per map, no iteration limit)\n";
+    cout << left << setw(20) << "Map" << setw(11) << "Build ms" << setw(10) << "Load ms" << setw(11) << "Table MB"
+         << setw(16) << "Exp straight" << setw(12) << "Exp ALT" << setw(9) << "Ratio" << setw(10) << "ms" << setw(10) << "ms ALT"
+         << "Cost match\n";
+    cout << string(110, '-') << "\n";
+    cout << fixed << setprecision(2);
+    for (Scenario& sc : scenarios) {
+        LandmarkHeuristic built;
+        built.build(sc.city, landmarkCount);
+        built.save(tablePath);
+        LandmarkHeuristic table;
+        bool loaded = table.load(tablePath, sc.city);
+        remove(tablePath.c_str());
+
+        auto queries = makeRandomQueries(sc.city, queryCount, 5, sc.maxZ);
+        GridPathFinder plain(&sc.city, 1.0);
+        plain.setMaxIterations(numeric_limits<int>::max());
+        GridPathFinder alt(&sc.city, 1.0);
+        alt.setMaxIterations(numeric_limits<int>::max());
+        alt.setLandmarks(loaded ? &table : &built);
+        long expPlain = 0, expAlt = 0;
+        double msPlain = 0, msAlt = 0;
+        int matches = 0;
+        for (const auto& q : queries) {
+            Stopwatch sw;
+            plain.findPath(q.start, q.end);
+            msPlain += sw.elapsedMs();
+            sw.restart();
+            alt.findPath(q.start, q.end);
+            msAlt += sw.elapsedMs();
+            expPlain += plain.getLastStats().expansions;
+            expAlt += alt.getLastStats().expansions;
+            if (fabs(alt.getLastStats().pathCost - plain.getLastStats().pathCost) < 1e-6) matches++;
+        }
+        cout << left << setw(20) << sc.name << setw(11) << built.getBuildMs();
+        if (loaded) cout << setw(10) << table.getBuildMs();
+        else cout << setw(10) << "failed";
+        cout << setw(11) << built.memoryBytes() / (1024.0 * 1024.0) << setw(16) << expPlain << setw(12) << expAlt
+             << setw(9) << (double)expPlain / max(1L, expAlt) << setw(10) << msPlain << setw(10) << msAlt
+             << matches << "/" << queries.size() << "\n";
+    }
+}
+
+// Reference cost for the lattice every A*-family planner here walks: plain
+// Dijkstra over all cells (no heuristic, no pruning, nothing shared with the
+// planners' open sets), then the cheapest goal-test cell plus its hop to the
+// end. -1 when the goal is unreachable.
+inline double bruteForceLatticeCost(const Map3D& map, const Vector3D& start, const Vector3D& end,
+                                    double step = 1.0) {
+    GridLattice lattice(map, start, step);
+    int startCell = lattice.cellOf(start);
+    if (startCell < 0) return -1;
+    vector<double> dist(lattice.cellCount(), numeric_limits<double>::infinity());
+    priority_queue<pair<double, int>, vector<pair<double, int>>, greater<pair<double, int>>> open;
+    dist[startCell] = 0;
+    open.push({0.0, startCell});
+    double best = numeric_limits<double>::infinity();
+    while (!open.empty()) {
+        pair<double, int> current = open.top();
+        open.pop();
+        if (current.first > dist[current.second]) continue;
+        int ci, cj, ck;
+        lattice.coords(current.second, ci, cj, ck);
+        Vector3D pos = lattice.position(ci, cj, ck);
+        if (pos.distanceTo(end) < step * 1.5) best = min(best, current.first + pos.distanceTo(end));
+        for (const NeighborOffset& o : kNeighborOffsets) {
+            int ni = ci + o.dx, nj = cj + o.dy, nk = ck + o.dz;
+            if (!lattice.inBounds(ni, nj, nk) || map.isBlocked(lattice.position(ni, nj, nk))) continue;
+            int next = lattice.index(ni, nj, nk);
+            double nd = current.first + o.cost * step;
+            if (nd >= dist[next]) continue;
+            dist[next] = nd;
+            open.push({nd, next});
+        }
+    }
+    return best == numeric_limits<double>::infinity() ? -1 : best;
+}
+
+// Optimality regression: every planner that claims A* costs against the
+// brute-force reference on small maps (direct-segment queries skipped, since
+// they never touch the lattice). Returns the number of mismatched costs, so
+// --check-optimality can fail a script or CI run.
+inline int benchOptimality(const Map3D& map, int queriesPerMap = 25) {
+    StreamStateGuard streamState;
+    vector<Map3D> cities;
+    cities.push_back(map);
+    for (unsigned seed = 1; seed <= 6; seed++) {
+        cities.push_back(makeRandomCity(30, 20, 12, 20 + seed * 6, seed));
+        // odd seeds plan on the baked bitmap, even ones on the obstacle list
+        if (seed % 2) cities.back().bakeOccupancy(1.0, 0.5);
+    }
+    const char* names[] = {"PathFinder3D", "GridPathFinder", "GridPathFinder + ALT", "JumpPointFinder",
+                           "BidirectionalPathFinder", "DStarLitePathFinder"};
+    const int planners = 6;
+    int checked = 0, unreachable = 0;
+    int matches[planners] = {0};
+    double worst[planners] = {0};
+    for (size_t m = 0; m < cities.size(); m++) {
+        const Map3D& city = cities[m];
+        LandmarkHeuristic table;
+        table.build(city, 8);
+        PathFinder3D classic(&city, 1.0, 0);
+        GridPathFinder grid(&city, 1.0);
+        GridPathFinder alt(&city, 1.0);
+        alt.setLandmarks(&table);
+        JumpPointFinder jps(&city, 1.0);
+        BidirectionalPathFinder bidirectional(&city, 1.0);
+        DStarLitePathFinder dstar(&city, 1.0);
+        classic.setMaxIterations(numeric_limits<int>::max());
+        grid.setMaxIterations(numeric_limits<int>::max());
+        alt.setMaxIterations(numeric_limits<int>::max());
+        jps.setMaxIterations(numeric_limits<int>::max());
+        bidirectional.setMaxIterations(numeric_limits<int>::max());
+        dstar.setMaxIterations(numeric_limits<int>::max());
+
+        for (const auto& q : makeRandomQueries(city, queriesPerMap, 100 + (unsigned)m, m == 0 ? 6 : 10)) {
+            if (city.isSegmentClear(q.start, q.end)) continue;
+            double reference = bruteForceLatticeCost(city, q.start, q.end);
+            if (reference < 0) {
+                unreachable++;
+                continue;
+            }
+            checked++;
+            classic.findPath(q.start, q.end);
+            grid.findPath(q.start, q.end);
+            alt.findPath(q.start, q.end);
+            jps.findPath(q.start, q.end);
+            bidirectional.findPath(q.start, q.end);
+            dstar.findPath(q.start, q.end);
+            double costs[planners] = {classic.getLastStats().pathCost, grid.getLastStats().pathCost,
+                                      alt.getLastStats().pathCost, jps.getLastStats().pathCost,
+                                      bidirectional.getLastStats().pathCost, dstar.getLastStats().pathCost};
+            for (int p = 0; p < planners; p++) {
+                double diff = fabs(costs[p] - reference);
+                if (diff < 1e-6) matches[p]++;
+                worst[p] = max(worst[p], diff);
+            }
+        }
+    }
+
+    cout << "\nPath optimality vs brute-force Dijkstra (" << map.getName() << " and 6 random 30x20x12 cities, "
+         << checked << " queries";
+    if (unreachable) cout << ", " << unreachable << " unreachable skipped";
+    cout << ")\n";
+    cout << left << setw(26) << "Planner" << setw(12) << "Optimal" << "Worst difference\n";
+    cout << string(50, '-') << "\n";
+    cout << fixed << setprecision(6);
+    for (int p = 0; p < planners; p++) {
+        cout << left << setw(26) << names[p] << setw(12) << (to_string(matches[p]) + "/" + to_string(checked))
+             << worst[p] << (matches[p] == checked ? "" : "  FAIL") << "\n";
+    }
+    int mismatches = 0;
+    for (int p = 0; p < planners; p++) mismatches += checked - matches[p];
+    return mismatches;
+}
+
+// one fixed-timestep step of the object model: each drone is a heap object
+// moved through the Vehicle interface, following its own copy of the route
+inline void stepDroneObjects(vector<unique_ptr<Drone>>& drones, const vector<vector<Vector3D>>& routes,
+                             vector<size_t>& routeOf, vector<size_t>& next, double dt) {
+    for (size_t i = 0; i < drones.size(); i++) {
+        Drone& drone = *drones[i];
+        const vector<Vector3D>& route = routes[routeOf[i]];
+        if (!drone.isFlying() || next[i] >= route.size()) continue;
+        double budget = drone.getSpeed() * dt;
+        while (budget > 0 && next[i] < route.size()) {
+            Vector3D here = drone.getPosition();
+            double d = here.distanceTo(route[next[i]]);
+            if (d <= budget) {
+                drone.move(route[next[i]++]);
+                budget -= d;
+            } else {
+                drone.move(here + (route[next[i]] - here) * (budget / d));
+                budget = 0;
+            }
+        }
+        if (next[i] < route.size() && drone.getBattery().getPercentage() < 5) drone.land();
+    }
+}
+
+// Fleet stepping at a fixed dt: Drone objects vs FleetSimulator's parallel
+// arrays, on one thread and on the whole machine
+inline void benchFleet(const Map3D& map, double dt = 0.1, int stepCount = 200) {
+    StreamStateGuard streamState;
+    GridPathFinder planner(&map, 1.0);
+    vector<vector<Vector3D>> routes;
+    for (const auto& q : makeRandomQueries(map, 64, 9)) routes.push_back(planner.findPath(q.start, q.end));
+    int cores = (int)thread::hardware_concurrency();
+
+    cout << "\nFleet simulation, dt " << defaultfloat << dt << " s, " << stepCount << " steps, " << routes.size()
+         << " routes on " << map.getName() << " (" << cores << " hardware threads)\n";
+    cout << left << setw(10) << "Drones" << setw(24) << "Engine" << setw(11) << "Threads" << setw(12) << "ms"
+         << setw(13) << "Steps/s" << setw(18) << "Drone-steps/s" << "Max position diff\n";
+    cout << string(100, '-') << "\n";
+    for (size_t fleetSize : {(size_t)10000, (size_t)100000}) {
+        // mixed fleet: the four drone types cycle, so speeds and batteries differ
+        vector<unique_ptr<Drone>> drones;
+        vector<size_t> routeOf(fleetSize), next(fleetSize, 0);
+        for (size_t i = 0; i < fleetSize; i++) {
+            string id = "FLT-" + to_string(i);
+            switch (i % 4) {
+            case 0: drones.push_back(make_unique<Drone>(id, "Basic")); break;
+            case 1: drones.push_back(make_unique<SurveyDrone>(id)); break;
+            case 2: drones.push_back(make_unique<DeliveryDrone>(id)); break;
+            default: drones.push_back(make_unique<RacingDrone>(id)); break;
+            }
+            routeOf[i] = i % routes.size();
+            drones.back()->setPosition(routes[routeOf[i]].front());
+            drones.back()->takeOff();
+        }
+
+        vector<unique_ptr<FleetSimulator>> fleets;
+        fleets.push_back(make_unique<FleetSimulator>(1));
+        if (cores > 1) fleets.push_back(make_unique<FleetSimulator>(cores));
+        for (auto& fleet : fleets) {
+            fleet->reserve(fleetSize);
+            for (const auto& route : routes) fleet->addRoute(route);
+            for (size_t i = 0; i < fleetSize; i++) fleet->addDrone(*drones[i], routeOf[i]);
+        }
+
+        Stopwatch sw;
+        for (int t = 0; t < stepCount; t++) stepDroneObjects(drones, routes, routeOf, next, dt);
+        double objectMs = sw.elapsedMs();
+        cout << fixed << setprecision(1);
+        cout << left << setw(10) << fleetSize << setw(24) << "Drone objects" << setw(11) << 1 << setw(12) << objectMs
+             << setw(13) << stepCount * 1000.0 / objectMs << setw(18) << setprecision(0)
+             << fleetSize * stepCount * 1000.0 / objectMs << "-\n";
+
+        for (auto& fleet : fleets) {
+            sw.restart();
+            for (int t = 0; t < stepCount; t++) fleet->step(dt);
+            double ms = sw.elapsedMs();
+            double worst = 0;
+            for (size_t i = 0; i < fleetSize; i++) {
+                worst = max(worst, fleet->getPosition(i).distanceTo(drones[i]->getPosition()));
+            }
+            cout << setprecision(1) << left << setw(10) << "" << setw(24) << "FleetSimulator (SoA)"
+                 << setw(11) << fleet->threadCount() << setw(12) << ms << setw(13) << stepCount * 1000.0 / ms
+                 << setw(18) << setprecision(0) << fleetSize * stepCount * 1000.0 / ms
+                 << setprecision(9) << worst << "\n";
+        }
+        const FleetSimulator& fleet = *fleets.back();
+        cout << "  after " << setprecision(1) << fleet.getSimTime() << " s: " << fleet.countStatus(FLEET_ARRIVED)
+             << " arrived, " << fleet.flyingCount() << " flying, "
+             << fleet.countStatus(FLEET_EMERGENCY) << " emergency landings\n";
+    }
+}
+
+#endif
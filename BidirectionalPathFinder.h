@@ -0,0 +1,262 @@
+// BidirectionalPathFinder.h - Bidirectional A* over the dense lattice
+#ifndef BIDIRECTIONALPATHFINDER_H
+#define BIDIRECTIONALPATHFINDER_H
+
+#include "Common.h"
+#include "Map.h"
+#include "PathFinder.h"
+#include "GridPathFinder.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <atomic>
+#include <mutex>
+using namespace std;
+
+// A* from both ends of the GridPathFinder lattice. The backward search
+// starts from every free cell the forward goal test accepts, at cost
+// |cell - end|, so both sides optimise the same total as A* does.
+// Both sides share the balanced potential p(v) = (|v - end| - |v - start|) / 2
+// (forward key g + p, backward key g - p), which keeps both consistent and
+// lets them stop as soon as the two smallest keys add up to the best
+// meeting found: the bidirectional Dijkstra criterion, so the result is
+// optimal. In the two-thread mode g and the top keys are shared through
+// atomics; a stale read only makes a side search longer.
+class BidirectionalPathFinder : public IPathFinder {
+private:
+    struct BiOpenEntry {
+        double f;
+        int cell;
+        bool operator>(const BiOpenEntry& other) const { return f > other.f; }
+    };
+
+    // one search direction; g and top are read by the other side
+    struct Side {
+        unique_ptr<atomic<double>[]> g;
+        size_t capacity;
+        vector<int> parent;
+        vector<uint64_t> closed;
+        vector<int> touched;
+        vector<BiOpenEntry> openSet;    // binary heap with lazy duplicates
+        double sign;                    // +1 forward, -1 backward: key = g + sign * p
+        atomic<double> top;             // smallest key still open (never decreases)
+        atomic<bool> done;              // this side has stopped
+        bool proved;                    // ... because the best meeting is optimal
+        SearchStats stats;
+
+        Side() : capacity(0), sign(1), top(0), done(false), proved(false) {}
+
+        inline bool isClosed(int cell) const { return (closed[cell >> 6] >> (cell & 63)) & 1ULL; }
+        inline void setClosed(int cell) { closed[cell >> 6] |= (1ULL << (cell & 63)); }
+        inline double cost(int cell) const { return g[cell].load(memory_order_relaxed); }
+
+        void reset(size_t n) {
+            for (int cell : touched) {
+                g[cell].store(numeric_limits<double>::infinity(), memory_order_relaxed);
+                parent[cell] = -1;
+                closed[cell >> 6] = 0;
+            }
+            touched.clear();
+            openSet.clear();
+            stats.reset();
+            done = false;
+            proved = false;
+            if (capacity < n) {
+                g.reset(new atomic<double>[n]);
+                for (size_t i = 0; i < n; i++) g[i].store(numeric_limits<double>::infinity(), memory_order_relaxed);
+                capacity = n;
+                parent.assign(n, -1);
+                closed.assign((n + 63) / 64, 0);
+            }
+        }
+
+        // with two threads the store is seq_cst, so of two sides labelling the
+        // same cell at once at least one sees the other's cost
+        void setCost(int cell, double cost, int from, memory_order order) {
+            if (g[cell].load(memory_order_relaxed) == numeric_limits<double>::infinity()) touched.push_back(cell);
+            g[cell].store(cost, order);
+            parent[cell] = from;
+        }
+
+        double minKey() const { return openSet.empty() ? numeric_limits<double>::infinity() : openSet.front().f; }
+    };
+
+    const Map3D* map;
+    double gridStep;
+    int maxIterations;
+    bool concurrent;
+
+    GridLattice lattice;
+    const VoxelGrid* occupancy;     // non-null when the baked bitmap shares this query's lattice
+    int startCell;
+    Vector3D queryStart, queryEnd;
+    Side sides[2];                  // 0 = forward from start, 1 = backward from the goal
+    ThreadPool pool;
+    SearchStats lastStats;
+
+    // best meeting so far
+    mutex meetLock;
+    atomic<double> bestCost;
+    int meetCell;
+    atomic<int> iterations;
+
+    double potential(const Vector3D& v) const { return 0.5 * (v.distanceTo(queryEnd) - v.distanceTo(queryStart)); }
+
+    bool isFree(int i, int j, int k) const {
+        return occupancy ? !occupancy->isBlocked(i, j, k) : !map->isBlocked(lattice.position(i, j, k));
+    }
+
+    void noteMeeting(int cell, double cost) {
+        if (cost >= bestCost.load(memory_order_relaxed)) return;
+        lock_guard<mutex> guard(meetLock);
+        if (cost < bestCost.load(memory_order_relaxed)) {
+            bestCost.store(cost, memory_order_relaxed);
+            meetCell = cell;
+        }
+    }
+
+    // one expansion on side s; false once that side has stopped
+    bool expand(int s) {
+        Side& self = sides[s];
+        const Side& other = sides[1 - s];
+        memory_order order = concurrent ? memory_order_seq_cst : memory_order_relaxed;
+        while (true) {
+            double top = self.minKey();
+            self.top.store(top, memory_order_relaxed);
+            // stale entries only lower our top and the other top only grows,
+            // so both reads err on the side of searching longer
+            if (top + other.top.load(memory_order_relaxed) >= bestCost.load(memory_order_relaxed)) {
+                self.proved = true;
+                break;
+            }
+            if (iterations.fetch_add(1, memory_order_relaxed) >= maxIterations) break;
+            pop_heap(self.openSet.begin(), self.openSet.end(), greater<BiOpenEntry>());
+            BiOpenEntry current = self.openSet.back();
+            self.openSet.pop_back();
+            if (self.isClosed(current.cell)) {
+                self.stats.stalePops++;
+                continue;
+            }
+            self.setClosed(current.cell);
+            self.stats.expansions++;
+
+            int ci, cj, ck;
+            lattice.coords(current.cell, ci, cj, ck);
+            double currentG = self.cost(current.cell);
+            for (const NeighborOffset& o : kNeighborOffsets) {
+                int ni = ci + o.dx, nj = cj + o.dy, nk = ck + o.dz;
+                if (!lattice.inBounds(ni, nj, nk)) continue;
+                int next = lattice.index(ni, nj, nk);
+                if (self.isClosed(next)) continue;
+                // the forward search never tests the start cell, so neither may the backward one
+                if (!(s == 1 && next == startCell) && !isFree(ni, nj, nk)) continue;
+
+                double newG = currentG + o.cost * gridStep;
+                if (newG >= self.cost(next)) continue;
+                self.setCost(next, newG, current.cell, order);
+                double otherG = other.g[next].load(order);
+                if (otherG != numeric_limits<double>::infinity()) noteMeeting(next, newG + otherG);
+                double key = newG + self.sign * potential(lattice.position(ni, nj, nk));
+                self.openSet.push_back({key, next});
+                push_heap(self.openSet.begin(), self.openSet.end(), greater<BiOpenEntry>());
+                self.stats.notePush(self.openSet.size());
+            }
+            return true;
+        }
+        self.done = true;
+        return false;
+    }
+
+public:
+    // concurrent = true runs each direction on its own thread
+    BidirectionalPathFinder(const Map3D* m, double step = 1.0, bool concurrent = false)
+        : map(m), gridStep(step), maxIterations(10000), concurrent(concurrent), occupancy(nullptr),
+          startCell(-1), pool(concurrent ? 2 : 1), bestCost(0), meetCell(-1), iterations(0) {
+        sides[1].sign = -1;
+    }
+
+    // pops on both sides together before giving up
+    void setMaxIterations(int n) { maxIterations = n; }
+    bool isConcurrent() const { return concurrent; }
+    // combined counters of both directions
+    const SearchStats& getLastStats() const { return lastStats; }
+    const SearchStats& getForwardStats() const { return sides[0].stats; }
+    const SearchStats& getBackwardStats() const { return sides[1].stats; }
+
+    vector<Vector3D> findPath(const Vector3D& start, const Vector3D& end) override {
+        vector<Vector3D> path;
+        lastStats.reset();
+
+        // Quick check for direct path
+        if (map->isSegmentClear(start, end)) {
+            path.push_back(start);
+            path.push_back(end);
+            return path;
+        }
+
+        lattice = GridLattice(*map, start, gridStep);
+        startCell = lattice.cellOf(start);
+        if (startCell < 0) return safeAltitudePath(map, start, end);
+        size_t n = (size_t)lattice.cellCount();
+        sides[0].reset(n);
+        sides[1].reset(n);
+        queryStart = start;
+        queryEnd = end;
+        bestCost.store(numeric_limits<double>::infinity());
+        meetCell = -1;
+        iterations.store(0);
+
+        occupancy = lattice.matchingOccupancy(*map);
+
+        // seeds: the start, and every cell the forward goal test accepts
+        sides[0].setCost(startCell, 0, -1, memory_order_relaxed);
+        sides[0].openSet.push_back({potential(start), startCell});
+        sides[0].stats.notePush(1);
+        lattice.forEachGoalCell(end, [&](int cell, int i, int j, int k, double toEnd) {
+            if (cell != startCell && !isFree(i, j, k)) return;
+            sides[1].setCost(cell, toEnd, -1, memory_order_relaxed);
+            sides[1].openSet.push_back({toEnd - potential(lattice.position(i, j, k)), cell});
+            sides[1].stats.notePush(sides[1].openSet.size());
+            if (cell == startCell) noteMeeting(cell, toEnd);
+        });
+        make_heap(sides[1].openSet.begin(), sides[1].openSet.end(), greater<BiOpenEntry>());
+        for (Side& side : sides) side.top.store(side.minKey());
+
+        if (concurrent) {
+            pool.parallelFor(2, [&](size_t s, int) {
+                while (!sides[1 - s].done && expand((int)s)) {}
+                sides[s].done = true;
+            });
+        } else {
+            // grow the smaller frontier (Pohl's cardinality rule) until either side stops
+            while (!sides[0].done && !sides[1].done) {
+                expand(sides[0].openSet.size() <= sides[1].openSet.size() ? 0 : 1);
+            }
+        }
+        lastStats.add(sides[0].stats);
+        lastStats.add(sides[1].stats);
+
+        // fly high above obstacles when the iteration budget ran out first
+        if (meetCell < 0 || !(sides[0].proved || sides[1].proved)) return safeAltitudePath(map, start, end);
+        lastStats.pathCost = sides[0].cost(meetCell) + sides[1].cost(meetCell);
+        for (int idx = meetCell; idx != -1; idx = sides[0].parent[idx]) {
+            path.push_back(lattice.position(idx));
+        }
+        reverse(path.begin(), path.end());
+        for (int idx = sides[1].parent[meetCell]; idx != -1; idx = sides[1].parent[idx]) {
+            path.push_back(lattice.position(idx));
+        }
+        path.push_back(end);
+        return smoothPathOnMap(map, path, &lastStats.segmentChecks);
+    }
+
+    double calculatePathDistance(const vector<Vector3D>& path) const {
+        return pathLength(path);
+    }
+};
+
+#endif
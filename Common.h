@@ -7,6 +7,7 @@
 #include <vector>
 #include <cmath>
 #include <limits>
+#include <algorithm>
 
 using namespace std;
 // Polymorphism
@@ -44,7 +45,8 @@ public:
     
     // distance calculation
     double distanceTo(const Vector3D& v) const {
-        return sqrt(pow(x - v.x, 2) + pow(y - v.y, 2) + pow(z - v.z, 2));
+        double dx = x - v.x, dy = y - v.y, dz = z - v.z;
+        return sqrt(dx * dx + dy * dy + dz * dz);
     }
     double magnitude() const {
         return sqrt(x*x + y*y + z*z);
@@ -115,6 +117,31 @@ public:
                 p.getZ() <= position.getZ() + height + margin);
     }
     
+    // exact segment test against the inflated box (slab method)
+    bool intersectsSegment(const Vector3D& a, const Vector3D& b, double margin = 1.0) const {
+        const double from[3] = {a.getX(), a.getY(), a.getZ()};
+        const double to[3] = {b.getX(), b.getY(), b.getZ()};
+        const double lo[3] = {position.getX() - margin, position.getY() - margin, position.getZ() - margin};
+        const double hi[3] = {position.getX() + length + margin, position.getY() + width + margin,
+                              position.getZ() + height + margin};
+        double tEnter = 0.0, tExit = 1.0;
+        for (int axis = 0; axis < 3; axis++) {
+            double d = to[axis] - from[axis];
+            if (fabs(d) < 1e-12) {
+                // parallel to this slab: must already be inside it
+                if (from[axis] < lo[axis] || from[axis] > hi[axis]) return false;
+                continue;
+            }
+            double t1 = (lo[axis] - from[axis]) / d;
+            double t2 = (hi[axis] - from[axis]) / d;
+            if (t1 > t2) swap(t1, t2);
+            if (t1 > tEnter) tEnter = t1;
+            if (t2 < tExit) tExit = t2;
+            if (tEnter > tExit) return false;
+        }
+        return true;
+    }
+    
     Vector3D getPosition() const { return position; }
     double getLength() const { return length; }
     double getWidth() const { return width; }
@@ -0,0 +1,332 @@
+// DStarLitePathFinder.h - Incremental replanning (D* Lite) for one active mission
+#ifndef DSTARLITEPATHFINDER_H
+#define DSTARLITEPATHFINDER_H
+
+#include "Common.h"
+#include "Map.h"
+#include "PathFinder.h"
+#include "GridPathFinder.h"
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <limits>
+using namespace std;
+
+// D* Lite (Koenig & Likhachev) on the GridPathFinder lattice of one mission.
+// findPath starts a mission: the search runs backward from the goal cells
+// (every free cell the A* goal test accepts, at cost |cell - end|) toward
+// the drone, so g-values stay valid as the drone moves. replan(position)
+// then picks up obstacles added with Map3D::addObstacle since the last call,
+// re-tests only the cells they cover, and repairs the costs that depend on
+// them. Any other map change restarts the mission. Keep one instance per
+// active mission.
+class DStarLitePathFinder : public IPathFinder {
+private:
+    // k1 ties are common on the lattice (straight runs sum to the same length)
+    // and rounding must not hide the k2 tie-break, so k1 compares with a tolerance
+    struct Key {
+        double k1, k2;
+        bool operator<(const Key& o) const {
+            return k1 < o.k1 - 1e-9 || (k1 <= o.k1 + 1e-9 && k2 < o.k2 - 1e-9);
+        }
+    };
+
+    struct QueueEntry {
+        Key key;
+        int cell;
+        bool operator>(const QueueEntry& other) const { return other.key < key; }
+    };
+
+    static const uint8_t kKnown = 1;
+    static const uint8_t kBlocked = 2;
+
+    const Map3D* map;
+    double gridStep;
+    int maxIterations;
+
+    // mission
+    bool active;
+    GridLattice lattice;
+    Vector3D goal;
+    vector<pair<int, double>> goalCells;    // cell, cost of the last hop to the goal
+    int startCell;
+    double km;                              // key offset accumulated as the drone moves
+    unsigned long seenRevision;
+    size_t seenObstacles;
+
+    // search state; only cells listed in 'touched' are dirty
+    vector<double> g, rhs;
+    vector<uint8_t> cellState;
+    vector<int> touched;
+    vector<QueueEntry> openSet;             // binary heap with lazy duplicates
+    SearchStats lastStats;
+    long lastChangedCells;
+
+    void touch(int cell) {
+        if (cellState[cell] == 0 && g[cell] == numeric_limits<double>::infinity() &&
+            rhs[cell] == numeric_limits<double>::infinity()) {
+            touched.push_back(cell);
+        }
+    }
+
+    void resetSearch() {
+        for (int cell : touched) {
+            g[cell] = rhs[cell] = numeric_limits<double>::infinity();
+            cellState[cell] = 0;
+        }
+        touched.clear();
+        openSet.clear();
+        size_t n = (size_t)lattice.cellCount();
+        if (g.size() < n) {
+            g.resize(n, numeric_limits<double>::infinity());
+            rhs.resize(n, numeric_limits<double>::infinity());
+            cellState.resize(n, 0);
+        }
+    }
+
+    bool isBlocked(int cell) {
+        if (!(cellState[cell] & kKnown)) {
+            touch(cell);
+            cellState[cell] = kKnown | (map->isBlocked(lattice.position(cell)) ? kBlocked : 0);
+        }
+        return cellState[cell] & kBlocked;
+    }
+
+    double heuristic(int a, int b) const { return lattice.position(a).distanceTo(lattice.position(b)); }
+
+    Key keyOf(int cell) const {
+        double m = min(g[cell], rhs[cell]);
+        return {m + heuristic(startCell, cell) + km, m};
+    }
+
+    double goalCost(int cell) const {
+        for (const auto& gc : goalCells) {
+            if (gc.first == cell) return gc.second;
+        }
+        return numeric_limits<double>::infinity();
+    }
+
+    // calls visit(neighbor, stepCost) for every in-bounds neighbour
+    template <typename Visit>
+    void forEachNeighbor(int cell, Visit visit) const {
+        int ci, cj, ck;
+        lattice.coords(cell, ci, cj, ck);
+        for (const NeighborOffset& o : kNeighborOffsets) {
+            int ni = ci + o.dx, nj = cj + o.dy, nk = ck + o.dz;
+            if (lattice.inBounds(ni, nj, nk)) visit(lattice.index(ni, nj, nk), o.cost * gridStep);
+        }
+    }
+
+    // one-step lookahead: cheapest way on from 'cell' (moves only enter free cells,
+    // and the drone's own cell is never tested, as in A*)
+    double lookahead(int cell) {
+        if (cell != startCell && isBlocked(cell)) return numeric_limits<double>::infinity();
+        double best = goalCost(cell);
+        forEachNeighbor(cell, [&](int next, double cost) {
+            if (g[next] + cost < best && !isBlocked(next)) best = g[next] + cost;
+        });
+        return best;
+    }
+
+    void updateVertex(int cell) {
+        touch(cell);
+        rhs[cell] = lookahead(cell);
+        if (g[cell] != rhs[cell]) {
+            openSet.push_back({keyOf(cell), cell});
+            push_heap(openSet.begin(), openSet.end(), greater<QueueEntry>());
+            lastStats.notePush(openSet.size());
+        }
+    }
+
+    // g[cell] just dropped: neighbours can only get cheaper, through this cell
+    void relaxAround(int cell) {
+        if (isBlocked(cell)) return;
+        forEachNeighbor(cell, [&](int prev, double cost) {
+            double through = g[cell] + cost;
+            if (through >= rhs[prev] || (prev != startCell && isBlocked(prev))) return;
+            touch(prev);
+            rhs[prev] = through;
+            openSet.push_back({keyOf(prev), prev});
+            push_heap(openSet.begin(), openSet.end(), greater<QueueEntry>());
+            lastStats.notePush(openSet.size());
+        });
+    }
+
+    void updateAround(int cell) {
+        updateVertex(cell);
+        forEachNeighbor(cell, [&](int next, double) { updateVertex(next); });
+    }
+
+    // false when the iteration budget ran out before the drone's cell settled
+    bool computeShortestPath() {
+        int iterations = 0;
+        while (!openSet.empty()) {
+            const QueueEntry top = openSet.front();
+            if (!(top.key < keyOf(startCell)) && rhs[startCell] == g[startCell]) return true;
+            if (iterations++ >= maxIterations) return false;
+            pop_heap(openSet.begin(), openSet.end(), greater<QueueEntry>());
+            openSet.pop_back();
+            int u = top.cell;
+            if (g[u] == rhs[u]) {
+                lastStats.stalePops++;
+                continue;
+            }
+            Key current = keyOf(u);
+            if (top.key < current) {
+                // queued before the drone moved (km grew): requeue at the current key
+                openSet.push_back({current, u});
+                push_heap(openSet.begin(), openSet.end(), greater<QueueEntry>());
+                continue;
+            }
+            lastStats.expansions++;
+            if (g[u] > rhs[u]) {
+                g[u] = rhs[u];
+                relaxAround(u);
+            } else {
+                g[u] = numeric_limits<double>::infinity();
+                updateAround(u);
+            }
+        }
+        return rhs[startCell] == g[startCell];
+    }
+
+    // re-test the lattice cells covered by obstacles added since the last call
+    void applyMapChanges() {
+        const vector<Obstacle>& obstacles = map->getObstacles();
+        for (size_t idx = seenObstacles; idx < obstacles.size(); idx++) {
+            const Obstacle& obs = obstacles[idx];
+            const double margin = 0.5;
+            Vector3D lo = obs.getPosition();
+            int i0 = max(0, (int)floor((lo.getX() - margin - lattice.originX) / gridStep));
+            int j0 = max(0, (int)floor((lo.getY() - margin - lattice.originY) / gridStep));
+            int k0 = max(0, (int)floor((lo.getZ() - margin - lattice.originZ) / gridStep));
+            int i1 = min(lattice.nx - 1, (int)ceil((lo.getX() + obs.getLength() + margin - lattice.originX) / gridStep));
+            int j1 = min(lattice.ny - 1, (int)ceil((lo.getY() + obs.getWidth() + margin - lattice.originY) / gridStep));
+            int k1 = min(lattice.nz - 1, (int)ceil((lo.getZ() + obs.getHeight() + margin - lattice.originZ) / gridStep));
+            for (int k = k0; k <= k1; k++) {
+                for (int j = j0; j <= j1; j++) {
+                    for (int i = i0; i <= i1; i++) {
+                        int cell = lattice.index(i, j, k);
+                        // cells never tested have not shaped any cost yet
+                        if (!(cellState[cell] & kKnown) || (cellState[cell] & kBlocked)) continue;
+                        if (!obs.containsPoint(lattice.position(i, j, k), margin)) continue;
+                        cellState[cell] |= kBlocked;
+                        lastChangedCells++;
+                        updateAround(cell);
+                    }
+                }
+            }
+        }
+        seenObstacles = obstacles.size();
+        seenRevision = map->getRevision();
+    }
+
+    // follow the cheapest lookahead from the drone's cell to a goal cell
+    vector<Vector3D> extractPath(const Vector3D& position) {
+        vector<Vector3D> path;
+        path.push_back(position);
+        int cell = startCell;
+        for (int steps = 0; steps < lattice.cellCount(); steps++) {
+            if (cell != startCell || lattice.position(cell).distanceTo(position) > 1e-9) {
+                path.push_back(lattice.position(cell));
+            }
+            double best = goalCost(cell);
+            int bestNext = -1;
+            forEachNeighbor(cell, [&](int next, double cost) {
+                if (g[next] + cost < best && !isBlocked(next)) {
+                    best = g[next] + cost;
+                    bestNext = next;
+                }
+            });
+            if (bestNext < 0) {
+                path.push_back(goal);
+                return smoothPathOnMap(map, path, &lastStats.segmentChecks);
+            }
+            cell = bestNext;
+        }
+        return safeAltitudePath(map, position, goal);
+    }
+
+    vector<Vector3D> plan(const Vector3D& position) {
+        if (!computeShortestPath() || rhs[startCell] == numeric_limits<double>::infinity()) {
+            return safeAltitudePath(map, position, goal);
+        }
+        lastStats.pathCost = rhs[startCell];
+        return extractPath(position);
+    }
+
+public:
+    DStarLitePathFinder(const Map3D* m, double step = 1.0)
+        : map(m), gridStep(step), maxIterations(10000), active(false), startCell(-1), km(0),
+          seenRevision(0), seenObstacles(0), lastChangedCells(0) {}
+
+    // expansions per findPath / replan call before falling back to safeAltitudePath
+    void setMaxIterations(int n) { maxIterations = n; }
+    const SearchStats& getLastStats() const { return lastStats; }
+    // lattice cells that became blocked before the last replan
+    long getLastChangedCells() const { return lastChangedCells; }
+    bool hasMission() const { return active; }
+    void endMission() { active = false; }
+
+    // plans from scratch and keeps the search state for replan()
+    vector<Vector3D> findPath(const Vector3D& start, const Vector3D& end) override {
+        lastStats.reset();
+        lastChangedCells = 0;
+        active = false;
+        goal = end;
+
+        // Quick check for direct path (replan starts a search if it gets blocked)
+        if (map->isSegmentClear(start, end)) {
+            vector<Vector3D> path;
+            path.push_back(start);
+            path.push_back(end);
+            return path;
+        }
+
+        lattice = GridLattice(*map, start, gridStep);
+        startCell = lattice.cellOf(start);
+        if (startCell < 0) return safeAltitudePath(map, start, end);
+        resetSearch();
+        active = true;
+        km = 0;
+        seenRevision = map->getRevision();
+        seenObstacles = map->getObstacles().size();
+
+        goalCells.clear();
+        lattice.forEachGoalCell(end, [&](int cell, int, int, int, double toEnd) {
+            goalCells.push_back(make_pair(cell, toEnd));
+        });
+        for (const auto& gc : goalCells) updateVertex(gc.first);
+        return plan(start);
+    }
+
+    // New route for the active mission from the drone's current position,
+    // repairing the previous search instead of starting over
+    vector<Vector3D> replan(const Vector3D& position) {
+        if (!active) return findPath(position, goal);
+        int cell = lattice.cellOf(position);
+        unsigned long added = map->getObstacles().size() - seenObstacles;
+        bool onlyAdded = map->getObstacles().size() >= seenObstacles && map->getRevision() - seenRevision == added;
+        if (cell < 0 || !onlyAdded) return findPath(position, goal);
+
+        lastStats.reset();
+        lastChangedCells = 0;
+        if (cell != startCell) {
+            km += heuristic(startCell, cell);
+            int previous = startCell;
+            startCell = cell;
+            // the drone's cell is exempt from the blocked test; move the exemption
+            updateVertex(previous);
+            updateVertex(startCell);
+        }
+        if (map->getRevision() != seenRevision) applyMapChanges();
+        return plan(position);
+    }
+
+    double calculatePathDistance(const vector<Vector3D>& path) const {
+        return pathLength(path);
+    }
+};
+
+#endif
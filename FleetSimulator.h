@@ -0,0 +1,175 @@
+// FleetSimulator.h - Fixed-timestep headless simulation of large drone fleets
+#ifndef FLEETSIMULATOR_H
+#define FLEETSIMULATOR_H
+
+#include "Common.h"
+#include "Drone.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+using namespace std;
+
+enum FleetStatus : uint8_t {
+    FLEET_FLYING = 0,
+    FLEET_ARRIVED = 1,
+    FLEET_EMERGENCY = 2     // battery under 5%, landed where it was (as simulateFlight does)
+};
+
+// Steps every drone of a fleet by the same dt. Each drone moves speed * dt
+// along its route per step (passing several waypoints if the legs are
+// short) and pays for the distance with the same consumption rate as
+// Battery::consume. Kinematic state lives in parallel arrays indexed by
+// drone, and routes live in one shared waypoint arena, so a step is a
+// linear pass over contiguous memory with no virtual calls. The pass is
+// split into fixed chunks on a ThreadPool; drones never interact, so chunks
+// need no locking and the result does not depend on the thread count.
+class FleetSimulator {
+private:
+    static const size_t kChunk = 2048;   // drones per parallel task
+
+    // waypoint arena; a route is [routeBegin[r], routeBegin[r + 1])
+    vector<double> wx, wy, wz;
+    vector<uint32_t> routeBegin;
+
+    // per-drone state
+    vector<double> px, py, pz;
+    vector<double> speed;
+    vector<double> charge, capacity, rate;
+    vector<double> flown;
+    vector<uint32_t> nextWaypoint, routeEnd;
+    vector<uint8_t> status;
+
+    ThreadPool pool;
+    vector<size_t> chunkLanded;     // drones that stopped flying, per chunk of the last step
+    size_t flying;
+    double simTime;
+    long steps;
+
+    // returns how many drones in [first, last) arrived or landed during this step
+    size_t stepRange(size_t first, size_t last, double dt) {
+        size_t landed = 0;
+        for (size_t i = first; i < last; i++) {
+            if (status[i] != FLEET_FLYING) continue;
+            double x = px[i], y = py[i], z = pz[i];
+            double budget = speed[i] * dt, moved = 0;
+            uint32_t w = nextWaypoint[i], end = routeEnd[i];
+            while (budget > 0 && w < end) {
+                double dx = wx[w] - x, dy = wy[w] - y, dz = wz[w] - z;
+                double d = sqrt(dx * dx + dy * dy + dz * dz);
+                if (d <= budget) {
+                    x = wx[w];
+                    y = wy[w];
+                    z = wz[w];
+                    budget -= d;
+                    moved += d;
+                    w++;
+                } else {
+                    double f = budget / d;
+                    x += dx * f;
+                    y += dy * f;
+                    z += dz * f;
+                    moved += budget;
+                    budget = 0;
+                }
+            }
+            px[i] = x;
+            py[i] = y;
+            pz[i] = z;
+            nextWaypoint[i] = w;
+            flown[i] += moved;
+            charge[i] = max(0.0, charge[i] - moved * rate[i]);
+            if (w == end) status[i] = FLEET_ARRIVED;
+            else if (charge[i] < capacity[i] * 0.05) status[i] = FLEET_EMERGENCY;
+            landed += status[i] != FLEET_FLYING;
+        }
+        return landed;
+    }
+
+public:
+    explicit FleetSimulator(int threads = (int)thread::hardware_concurrency())
+        : routeBegin(1, 0), pool(threads), flying(0), simTime(0), steps(0) {}
+
+    // store a route once; any number of drones can fly it
+    size_t addRoute(const vector<Vector3D>& path) {
+        for (const auto& p : path) {
+            wx.push_back(p.getX());
+            wy.push_back(p.getY());
+            wz.push_back(p.getZ());
+        }
+        routeBegin.push_back((uint32_t)wx.size());
+        return routeBegin.size() - 2;
+    }
+
+    // copies the drone's speed and battery; it starts on the route's first waypoint
+    size_t addDrone(const Drone& drone, size_t route) {
+        uint32_t first = routeBegin[route], last = routeBegin[route + 1];
+        px.push_back(first < last ? wx[first] : drone.getPosition().getX());
+        py.push_back(first < last ? wy[first] : drone.getPosition().getY());
+        pz.push_back(first < last ? wz[first] : drone.getPosition().getZ());
+        speed.push_back(drone.getSpeed());
+        const Battery& battery = drone.getBattery();
+        charge.push_back(battery.getCharge());
+        capacity.push_back(battery.getCapacity());
+        rate.push_back(battery.getConsumptionRate());
+        flown.push_back(0);
+        nextWaypoint.push_back(first);
+        routeEnd.push_back(last);
+        status.push_back(first < last ? FLEET_FLYING : FLEET_ARRIVED);
+        if (first < last) flying++;
+        return px.size() - 1;
+    }
+
+    void reserve(size_t drones) {
+        px.reserve(drones);
+        py.reserve(drones);
+        pz.reserve(drones);
+        speed.reserve(drones);
+        charge.reserve(drones);
+        capacity.reserve(drones);
+        rate.reserve(drones);
+        flown.reserve(drones);
+        nextWaypoint.reserve(drones);
+        routeEnd.reserve(drones);
+        status.reserve(drones);
+    }
+
+    void step(double dt) {
+        size_t n = px.size(), chunks = (n + kChunk - 1) / kChunk;
+        chunkLanded.assign(chunks, 0);
+        pool.parallelFor(chunks, [&](size_t chunk, int) {
+            chunkLanded[chunk] = stepRange(chunk * kChunk, min(n, (chunk + 1) * kChunk), dt);
+        });
+        for (size_t landed : chunkLanded) flying -= landed;
+        simTime += dt;
+        steps++;
+    }
+
+    // steps until every drone has arrived or landed, or maxSteps; returns the steps taken
+    long run(double dt, long maxSteps) {
+        long taken = 0;
+        while (taken < maxSteps && flying > 0) {
+            step(dt);
+            taken++;
+        }
+        return taken;
+    }
+
+    // one pass over the fleet; for reports, not per step
+    size_t countStatus(FleetStatus s) const { return (size_t)count(status.begin(), status.end(), (uint8_t)s); }
+
+    size_t flyingCount() const { return flying; }
+    size_t size() const { return px.size(); }
+    size_t waypointCount() const { return wx.size(); }
+    int threadCount() const { return pool.size(); }
+    double getSimTime() const { return simTime; }
+    long getSteps() const { return steps; }
+    Vector3D getPosition(size_t i) const { return Vector3D(px[i], py[i], pz[i]); }
+    double getDistanceFlown(size_t i) const { return flown[i]; }
+    double getBatteryPercentage(size_t i) const { return charge[i] / capacity[i] * 100.0; }
+    FleetStatus getStatus(size_t i) const { return (FleetStatus)status[i]; }
+};
+
+#endif
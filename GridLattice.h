@@ -0,0 +1,130 @@
+// GridLattice.h - Dense lattice of candidate positions shared by the grid planners
+#ifndef GRIDLATTICE_H
+#define GRIDLATTICE_H
+
+#include "Common.h"
+#include "Map.h"
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+using namespace std;
+
+// Lattice of candidate positions for one query.
+// Anchored at the start point like PathFinder3D (start + k * step), so both
+// engines explore exactly the same node set and can be compared query by query.
+struct GridLattice {
+    double originX, originY, originZ;
+    double step;
+    int nx, ny, nz;
+
+    GridLattice() : originX(0), originY(0), originZ(0), step(1.0), nx(0), ny(0), nz(0) {}
+
+    GridLattice(const Map3D& map, const Vector3D& anchor, double s) : step(s) {
+        originX = anchor.getX() - floor(anchor.getX() / step) * step;
+        originY = anchor.getY() - floor(anchor.getY() / step) * step;
+        originZ = anchor.getZ() - floor(anchor.getZ() / step) * step;
+        nx = max(0, (int)ceil((map.getWidth() - originX) / step));
+        ny = max(0, (int)ceil((map.getDepth() - originY) / step));
+        nz = max(0, (int)ceil((map.getHeight() - originZ) / step));
+    }
+
+    int cellCount() const { return nx * ny * nz; }
+
+    bool inBounds(int i, int j, int k) const {
+        return i >= 0 && i < nx && j >= 0 && j < ny && k >= 0 && k < nz;
+    }
+
+    // flat offset: x fastest, then y, then z
+    inline int index(int i, int j, int k) const { return (k * ny + j) * nx + i; }
+
+    inline void coords(int idx, int& i, int& j, int& k) const {
+        i = idx % nx;
+        j = (idx / nx) % ny;
+        k = idx / (nx * ny);
+    }
+
+    inline Vector3D position(int i, int j, int k) const {
+        return Vector3D(originX + i * step, originY + j * step, originZ + k * step);
+    }
+
+    Vector3D position(int idx) const {
+        int i, j, k;
+        coords(idx, i, j, k);
+        return position(i, j, k);
+    }
+
+    // nearest lattice cell to a point (-1 if outside the lattice)
+    int cellOf(const Vector3D& p) const {
+        int i = (int)floor((p.getX() - originX) / step + 0.5);
+        int j = (int)floor((p.getY() - originY) / step + 0.5);
+        int k = (int)floor((p.getZ() - originZ) / step + 0.5);
+        return inBounds(i, j, k) ? index(i, j, k) : -1;
+    }
+
+    // the map's baked bitmap when it samples exactly this lattice, else nullptr
+    const VoxelGrid* matchingOccupancy(const Map3D& map, double margin = 0.5) const {
+        const VoxelGrid& voxels = map.getOccupancy();
+        Vector3D origin = position(0, 0, 0);
+        if (voxels.matches(origin, step, margin) && voxels.getOrigin().distanceTo(origin) < 1e-6 &&
+            voxels.getSizeX() == nx && voxels.getSizeY() == ny && voxels.getSizeZ() == nz) {
+            return &voxels;
+        }
+        return nullptr;
+    }
+
+    // visit(cell, i, j, k, distance to end) for every cell the planners' goal
+    // test accepts: within 1.5 steps of the (usually off-lattice) end point
+    template <typename Visit>
+    void forEachGoalCell(const Vector3D& end, Visit visit) const {
+        int ei = (int)floor((end.getX() - originX) / step + 0.5);
+        int ej = (int)floor((end.getY() - originY) / step + 0.5);
+        int ek = (int)floor((end.getZ() - originZ) / step + 0.5);
+        for (int k = ek - 2; k <= ek + 2; k++) {
+            for (int j = ej - 2; j <= ej + 2; j++) {
+                for (int i = ei - 2; i <= ei + 2; i++) {
+                    if (!inBounds(i, j, k)) continue;
+                    double toEnd = position(i, j, k).distanceTo(end);
+                    if (toEnd < step * 1.5) visit(index(i, j, k), i, j, k, toEnd);
+                }
+            }
+        }
+    }
+};
+
+// Dense per-cell search state (g-score, parent, closed bit) for planners
+// walking a GridLattice. Kept across queries; only cells listed in 'touched'
+// are dirty, so a reset costs O(cells touched).
+struct LatticeSearch {
+    vector<double> gScore;
+    vector<int> parent;
+    vector<uint64_t> closed;
+    vector<int> touched;
+
+    inline bool isClosed(int cell) const { return (closed[cell >> 6] >> (cell & 63)) & 1ULL; }
+    inline void setClosed(int cell) { closed[cell >> 6] |= (1ULL << (cell & 63)); }
+
+    inline void touch(int cell, double g, int from) {
+        if (gScore[cell] == numeric_limits<double>::infinity()) touched.push_back(cell);
+        gScore[cell] = g;
+        parent[cell] = from;
+    }
+
+    // undo the previous search; grow the arrays only when the lattice grows
+    void reset(size_t cells) {
+        for (int cell : touched) {
+            gScore[cell] = numeric_limits<double>::infinity();
+            parent[cell] = -1;
+            closed[cell >> 6] = 0;
+        }
+        touched.clear();
+        if (gScore.size() < cells) {
+            gScore.resize(cells, numeric_limits<double>::infinity());
+            parent.resize(cells, -1);
+            closed.resize((cells + 63) / 64, 0);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,134 @@
+// GridPathFinder.h - A* over a dense lattice with integer cell indices
+#ifndef GRIDPATHFINDER_H
+#define GRIDPATHFINDER_H
+
+#include "Common.h"
+#include "Map.h"
+#include "PathFinder.h"
+#include "GridLattice.h"
+#include "LandmarkHeuristic.h"
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+using namespace std;
+
+// A* engine with dense g-score / parent arrays and a closed bitset sized to the grid.
+// Drop-in replacement for PathFinder3D (same moves, margins, goal test and smoothing)
+// without string keys or hash lookups in the inner loop.
+class GridPathFinder : public IPathFinder {
+private:
+    struct GridOpenEntry {
+        double f;
+        double g;
+        int cell;
+        bool operator>(const GridOpenEntry& other) const { return f > other.f; }
+    };
+
+    const Map3D* map;
+    double gridStep;
+    int maxIterations;
+
+    GridLattice lattice;
+    const VoxelGrid* occupancy;     // non-null when the baked bitmap shares this query's lattice
+    LatticeSearch search;               // workspace kept across queries
+    vector<GridOpenEntry> openSet;      // binary heap with lazy duplicates
+    SearchStats lastStats;
+    const LandmarkHeuristic* landmarks; // optional ALT table
+    LandmarkGoal landmarkGoal;
+
+public:
+    GridPathFinder(const Map3D* m, double step = 1.0)
+        : map(m), gridStep(step), maxIterations(10000), occupancy(nullptr), landmarks(nullptr) {}
+
+    void setMaxIterations(int n) { maxIterations = n; }
+    // used for queries on the table's map and lattice, straight-line distance otherwise
+    void setLandmarks(const LandmarkHeuristic* table) { landmarks = table; }
+    double getGridStep() const { return gridStep; }
+    const SearchStats& getLastStats() const { return lastStats; }
+
+    vector<Vector3D> findPath(const Vector3D& start, const Vector3D& end) override {
+        vector<Vector3D> path;
+        lastStats.reset();
+
+        // Quick check for direct path
+        if (map->isSegmentClear(start, end)) {
+            path.push_back(start);
+            path.push_back(end);
+            return path;
+        }
+
+        lattice = GridLattice(*map, start, gridStep);
+        int startCell = lattice.cellOf(start);
+        if (startCell < 0) return safeAltitudePath(map, start, end);
+        search.reset((size_t)lattice.cellCount());
+        openSet.clear();
+
+        occupancy = lattice.matchingOccupancy(*map);
+        bool useLandmarks = landmarks && landmarks->matches(*map, lattice) &&
+                            landmarks->prepareGoal(end, landmarkGoal);
+
+        search.touch(startCell, 0, -1);
+        openSet.push_back({start.distanceTo(end), 0, startCell});
+        lastStats.notePush(openSet.size());
+
+        int iterations = 0;
+        while (!openSet.empty() && iterations < maxIterations) {
+            iterations++;
+            pop_heap(openSet.begin(), openSet.end(), greater<GridOpenEntry>());
+            GridOpenEntry current = openSet.back();
+            openSet.pop_back();
+
+            if (search.isClosed(current.cell)) {
+                lastStats.stalePops++;
+                continue;
+            }
+            search.setClosed(current.cell);
+            lastStats.expansions++;
+
+            int ci, cj, ck;
+            lattice.coords(current.cell, ci, cj, ck);
+            Vector3D currentPos = lattice.position(ci, cj, ck);
+
+            // Check if reached destination
+            if (currentPos.distanceTo(end) < gridStep * 1.5) {
+                lastStats.pathCost = current.g + currentPos.distanceTo(end);
+                for (int idx = current.cell; idx != -1; idx = search.parent[idx]) {
+                    path.push_back(lattice.position(idx));
+                }
+                reverse(path.begin(), path.end());
+                path.push_back(end);
+                return smoothPathOnMap(map, path, &lastStats.segmentChecks);
+            }
+
+            // 26-directional movement from the shared offset table
+            for (const NeighborOffset& o : kNeighborOffsets) {
+                int ni = ci + o.dx, nj = cj + o.dy, nk = ck + o.dz;
+                if (!lattice.inBounds(ni, nj, nk)) continue;
+                int next = lattice.index(ni, nj, nk);
+                if (search.isClosed(next)) continue;
+
+                Vector3D nextPos = lattice.position(ni, nj, nk);
+                if (occupancy ? occupancy->isBlocked(ni, nj, nk) : map->isBlocked(nextPos)) continue;
+
+                double newG = current.g + o.cost * gridStep;
+                if (newG >= search.gScore[next]) continue;
+                search.touch(next, newG, current.cell);
+                double h = nextPos.distanceTo(end);
+                if (useLandmarks) h = max(h, landmarks->estimate(landmarkGoal, next));
+                openSet.push_back({newG + h, newG, next});
+                push_heap(openSet.begin(), openSet.end(), greater<GridOpenEntry>());
+                lastStats.notePush(openSet.size());
+            }
+        }
+
+        // fly high above obstacles
+        return safeAltitudePath(map, start, end);
+    }
+
+    double calculatePathDistance(const vector<Vector3D>& path) const {
+        return pathLength(path);
+    }
+};
+
+#endif
@@ -0,0 +1,615 @@
+// HierarchicalPathFinder.h - HPA*: plan over cluster entrances, then refine inside clusters
+#ifndef HIERARCHICALPATHFINDER_H
+#define HIERARCHICALPATHFINDER_H
+
+#include "Common.h"
+#include "Map.h"
+#include "PathFinder.h"
+#include "VoxelGrid.h"
+#include "IndexedHeap.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <thread>
+using namespace std;
+
+// lattice cost between two cells with no obstacles in between (26-connected moves)
+inline double octileDistance(int di, int dj, int dk) {
+    int a = abs(di), b = abs(dj), c = abs(dk);
+    if (a < b) swap(a, b);
+    if (b < c) swap(b, c);
+    if (a < b) swap(a, b);
+    return c * kStepCorner + (b - c) * kStepDiagonal + (a - b) * kStepStraight;
+}
+
+// size and cost of the abstract graph (see getHierarchyStats)
+struct HierarchyStats {
+    int clusters;
+    int entrances;          // abstract nodes
+    long edges;             // directed abstract edges
+    int builds;
+    double buildMs;         // last build
+    size_t memoryBytes;     // occupancy bitmap plus abstract graph
+
+    HierarchyStats() : clusters(0), entrances(0), edges(0), builds(0), buildMs(0), memoryBytes(0) {}
+};
+
+// Hierarchical A* (HPA*) for maps too large for a flat lattice search.
+// The lattice (origin-anchored, one bit per cell) is cut into clusters of
+// clusterSize x clusterSize x clusterHeight cells. Where two clusters touch,
+// each connected free patch of the shared face gets entrance cells on both
+// sides, sampled every entranceSpacing cells; a cluster-local search gives the
+// cost between every pair of entrances of a cluster. A query links start and
+// goal to the entrances of their clusters, runs A* on that small graph, and
+// refines each abstract hop with an A* confined to one cluster.
+// The build runs on the first query and again whenever the map revision
+// changes, so its cost is shared by every query in between.
+class HierarchicalPathFinder : public IPathFinder {
+private:
+    struct Edge {
+        int to;
+        double cost;
+    };
+
+    struct Node {
+        int cell;
+        int cluster;
+        vector<Edge> edges;
+    };
+
+    // Cell range of one cluster. Local searches index a copy of the box
+    // padded by one blocked cell on every side, so a neighbour is one add
+    // away and never needs a bounds check.
+    struct Box {
+        int i0, j0, k0;
+        int sx, sy, sz;
+
+        int px() const { return sx + 2; }
+        int py() const { return sy + 2; }
+        int paddedVolume() const { return px() * py() * (sz + 2); }
+        int local(int i, int j, int k) const { return ((k - k0 + 1) * py() + (j - j0 + 1)) * px() + (i - i0 + 1); }
+        void coords(int l, int& i, int& j, int& k) const {
+            i = i0 + l % px() - 1;
+            j = j0 + l / px() % py() - 1;
+            k = k0 + l / (px() * py()) - 1;
+        }
+    };
+
+    // box-local search arrays; one per build worker plus one for queries
+    struct LocalSearch {
+        vector<uint8_t> blocked;    // padded box occupancy
+        vector<double> g;
+        vector<int> parent;
+        vector<uint8_t> closed;
+        vector<uint8_t> target;
+        vector<OpenEntry> open;     // binary heap with lazy duplicates
+        int loaded;                 // cluster held in 'blocked' (-1 = none)
+        long expansions;
+
+        LocalSearch() : loaded(-1), expansions(0) {}
+    };
+
+    const Map3D* map;
+    double gridStep;
+    int clusterSize;
+    int clusterHeight;      // 0 = whole map height
+    int entranceSpacing;
+
+    VoxelGrid grid;
+    int nx, ny, nz;
+    int ccx, ccy, ccz;      // clusters per axis
+    vector<Node> nodes;
+    vector<vector<int>> clusterNodes;
+    unordered_map<int, int> nodeOfCell;
+    bool built;
+    unsigned long builtRevision;
+
+    ThreadPool pool;
+    vector<LocalSearch> buildSearch;
+    LocalSearch querySearch;
+    vector<double> abstractG;
+    vector<int> abstractParent;
+    vector<double> goalLink;     // cost from an entrance of the goal's cluster to the goal
+    IndexedHeap abstractOpen;
+
+    HierarchyStats hierarchy;
+    SearchStats lastStats;
+
+    inline int cellIndex(int i, int j, int k) const { return (k * ny + j) * nx + i; }
+
+    inline void cellCoords(int cell, int& i, int& j, int& k) const {
+        i = cell % nx;
+        j = (cell / nx) % ny;
+        k = cell / (nx * ny);
+    }
+
+    bool isFree(int cell) const {
+        int i, j, k;
+        cellCoords(cell, i, j, k);
+        return !grid.isBlocked(i, j, k);
+    }
+
+    int clusterOf(int cell) const {
+        int i, j, k;
+        cellCoords(cell, i, j, k);
+        int h = clusterHeight > 0 ? clusterHeight : nz;
+        return ((k / h) * ccy + j / clusterSize) * ccx + i / clusterSize;
+    }
+
+    Box boxOf(int cluster) const {
+        int h = clusterHeight > 0 ? clusterHeight : nz;
+        Box b;
+        b.i0 = (cluster % ccx) * clusterSize;
+        b.j0 = (cluster / ccx % ccy) * clusterSize;
+        b.k0 = cluster / (ccx * ccy) * h;
+        b.sx = min(clusterSize, nx - b.i0);
+        b.sy = min(clusterSize, ny - b.j0);
+        b.sz = min(h, nz - b.k0);
+        return b;
+    }
+
+    Vector3D positionOf(int cell) const {
+        int i, j, k;
+        cellCoords(cell, i, j, k);
+        return grid.samplePoint(i, j, k);
+    }
+
+    double heuristic(int from, int to) const {
+        int i, j, k, ti, tj, tk;
+        cellCoords(from, i, j, k);
+        cellCoords(to, ti, tj, tk);
+        return octileDistance(i - ti, j - tj, k - tk) * gridStep;
+    }
+
+    int nodeFor(int cell, int cluster) {
+        auto it = nodeOfCell.find(cell);
+        if (it != nodeOfCell.end()) return it->second;
+        Node n;
+        n.cell = cell;
+        n.cluster = cluster;
+        nodes.push_back(n);
+        clusterNodes[cluster].push_back((int)nodes.size() - 1);
+        nodeOfCell[cell] = (int)nodes.size() - 1;
+        return (int)nodes.size() - 1;
+    }
+
+    // copy one cluster's occupancy into the padded local layout
+    void loadBox(LocalSearch& ws, int cluster, const Box& b) const {
+        if (ws.loaded == cluster) return;
+        ws.blocked.assign((size_t)b.paddedVolume(), 1);
+        for (int k = b.k0; k < b.k0 + b.sz; k++) {
+            for (int j = b.j0; j < b.j0 + b.sy; j++) {
+                for (int i = b.i0; i < b.i0 + b.sx; i++) ws.blocked[(size_t)b.local(i, j, k)] = grid.isBlocked(i, j, k);
+            }
+        }
+        ws.loaded = cluster;
+    }
+
+    // Dijkstra (goal < 0) or A* (goal >= 0) from source without leaving the
+    // cluster. With targets, Dijkstra stops once all of them are settled.
+    // ws.g holds costs in lattice steps, indexed by Box::local.
+    bool searchBox(LocalSearch& ws, int cluster, int source, int goal, const vector<int>* targets) const {
+        Box b = boxOf(cluster);
+        loadBox(ws, cluster, b);
+        size_t volume = (size_t)b.paddedVolume();
+        ws.g.assign(volume, numeric_limits<double>::infinity());
+        ws.parent.assign(volume, -1);
+        ws.closed.assign(volume, 0);
+        ws.open.clear();
+
+        int i, j, k;
+        int remaining = 0;
+        if (targets) {
+            ws.target.assign(volume, 0);
+            for (int cell : *targets) {
+                cellCoords(cell, i, j, k);
+                uint8_t& mark = ws.target[(size_t)b.local(i, j, k)];
+                if (!mark) remaining++;
+                mark = 1;
+            }
+            if (remaining == 0) return true;
+        }
+        int gi = 0, gj = 0, gk = 0, goalLocal = -1;
+        if (goal >= 0) {
+            cellCoords(goal, gi, gj, gk);
+            goalLocal = b.local(gi, gj, gk);
+        }
+        int delta[26];
+        for (int n = 0; n < 26; n++) {
+            delta[n] = (kNeighborOffsets[n].dz * b.py() + kNeighborOffsets[n].dy) * b.px() + kNeighborOffsets[n].dx;
+        }
+
+        cellCoords(source, i, j, k);
+        int src = b.local(i, j, k);
+        ws.g[(size_t)src] = 0;
+        ws.open.push_back(OpenEntry(goal >= 0 ? octileDistance(i - gi, j - gj, k - gk) : 0, src));
+
+        while (!ws.open.empty()) {
+            pop_heap(ws.open.begin(), ws.open.end(), greater<OpenEntry>());
+            int cur = ws.open.back().node;
+            ws.open.pop_back();
+            if (ws.closed[(size_t)cur]) continue;
+            ws.closed[(size_t)cur] = 1;
+            ws.expansions++;
+            if (cur == goalLocal) return true;
+            if (targets && ws.target[(size_t)cur] && --remaining == 0) return true;
+
+            if (goal >= 0) b.coords(cur, i, j, k);
+            double curG = ws.g[(size_t)cur];
+            for (int n = 0; n < 26; n++) {
+                int next = cur + delta[n];
+                if (ws.blocked[(size_t)next] || ws.closed[(size_t)next]) continue;
+                double newG = curG + kNeighborOffsets[n].cost;
+                if (newG >= ws.g[(size_t)next]) continue;
+                ws.g[(size_t)next] = newG;
+                ws.parent[(size_t)next] = cur;
+                double f = newG;
+                if (goal >= 0) {
+                    const NeighborOffset& o = kNeighborOffsets[n];
+                    f += octileDistance(i + o.dx - gi, j + o.dy - gj, k + o.dz - gk);
+                }
+                ws.open.push_back(OpenEntry(f, next));
+                push_heap(ws.open.begin(), ws.open.end(), greater<OpenEntry>());
+            }
+        }
+        return false;
+    }
+
+    // Diagonal-first lattice walk (step every axis that still differs). Its
+    // cost is the octile distance, a lower bound, so when it is clear it is
+    // optimal. Monotone, so it never leaves the endpoints' cluster.
+    bool diagonalWalk(int from, int to, vector<int>* cells) const {
+        int i, j, k, ti, tj, tk;
+        cellCoords(from, i, j, k);
+        cellCoords(to, ti, tj, tk);
+        size_t mark = cells ? cells->size() : 0;
+        while (i != ti || j != tj || k != tk) {
+            i += (ti > i) - (ti < i);
+            j += (tj > j) - (tj < j);
+            k += (tk > k) - (tk < k);
+            if (grid.isBlocked(i, j, k)) {
+                if (cells) cells->resize(mark);
+                return false;
+            }
+            if (cells) cells->push_back(cellIndex(i, j, k));
+        }
+        return true;
+    }
+
+    // Cost (map units) from source to each target inside one cluster,
+    // infinity if unreachable without leaving it. Targets with a clear
+    // diagonal walk are settled directly; Dijkstra runs for the rest.
+    void clusterCosts(LocalSearch& ws, int cluster, int source, const vector<int>& targets,
+                      vector<double>& costs) const {
+        costs.assign(targets.size(), numeric_limits<double>::infinity());
+        vector<int> pending;
+        for (size_t t = 0; t < targets.size(); t++) {
+            // the reverse walk is the straight-first path from source
+            if (diagonalWalk(source, targets[t], nullptr) || diagonalWalk(targets[t], source, nullptr)) {
+                costs[t] = heuristic(source, targets[t]);
+            } else {
+                pending.push_back(targets[t]);
+            }
+        }
+        if (pending.empty()) return;
+        // a focused A* per target beats sweeping the whole cluster unless many remain
+        bool sweep = pending.size() > 8;
+        if (sweep) searchBox(ws, cluster, source, -1, &pending);
+        Box b = boxOf(cluster);
+        int i, j, k;
+        for (size_t t = 0; t < targets.size(); t++) {
+            if (costs[t] != numeric_limits<double>::infinity()) continue;
+            if (!sweep && !searchBox(ws, cluster, source, targets[t], nullptr)) continue;
+            cellCoords(targets[t], i, j, k);
+            costs[t] = ws.g[(size_t)b.local(i, j, k)] * gridStep;
+        }
+    }
+
+    // Entrances through the face between a cluster and its neighbour along
+    // one axis. Free cell pairs across the face are grouped into 4-connected
+    // patches; each patch gets the pairs on an entranceSpacing sub-grid, or its
+    // most central pair if the sub-grid misses it.
+    void addEntrances(int cluster, int axis) {
+        Box b = boxOf(cluster);
+        int d[3] = {0, 0, 0};
+        d[axis] = 1;
+        int ua = (axis + 1) % 3, va = (axis + 2) % 3;
+        int lo[3] = {b.i0, b.j0, b.k0};
+        int size[3] = {b.sx, b.sy, b.sz};
+        int limit[3] = {nx, ny, nz};
+        int face = lo[axis] + size[axis] - 1;
+        if (face + 1 >= limit[axis]) return;
+        int neighbor = clusterOf(cellIndex(b.i0 + d[0] * b.sx, b.j0 + d[1] * b.sy, b.k0 + d[2] * b.sz));
+
+        int su = size[ua], sv = size[va];
+        // cell (u, v) of the face on this side (shift 0) or the neighbour's (shift 1)
+        auto cellAt = [&](int u, int v, int shift) {
+            int c[3];
+            c[axis] = face + shift;
+            c[ua] = lo[ua] + u;
+            c[va] = lo[va] + v;
+            return cellIndex(c[0], c[1], c[2]);
+        };
+        vector<uint8_t> open((size_t)su * sv, 0);
+        for (int v = 0; v < sv; v++) {
+            for (int u = 0; u < su; u++) {
+                open[(size_t)v * su + u] = isFree(cellAt(u, v, 0)) && isFree(cellAt(u, v, 1));
+            }
+        }
+
+        vector<int> patch, stack;
+        int half = entranceSpacing / 2;
+        for (int seed = 0; seed < su * sv; seed++) {
+            if (open[(size_t)seed] != 1) continue;
+            patch.clear();
+            stack.assign(1, seed);
+            open[(size_t)seed] = 2;
+            double cu = 0, cv = 0;
+            while (!stack.empty()) {
+                int p = stack.back();
+                stack.pop_back();
+                patch.push_back(p);
+                int u = p % su, v = p / su;
+                cu += u;
+                cv += v;
+                const int du[4] = {1, -1, 0, 0}, dv[4] = {0, 0, 1, -1};
+                for (int n = 0; n < 4; n++) {
+                    int nu = u + du[n], nv = v + dv[n];
+                    if (nu < 0 || nu >= su || nv < 0 || nv >= sv) continue;
+                    int q = nv * su + nu;
+                    if (open[(size_t)q] != 1) continue;
+                    open[(size_t)q] = 2;
+                    stack.push_back(q);
+                }
+            }
+            cu /= patch.size();
+            cv /= patch.size();
+
+            vector<int> chosen;
+            int central = patch[0];
+            double best = numeric_limits<double>::infinity();
+            for (int p : patch) {
+                int u = p % su, v = p / su;
+                if (u % entranceSpacing == half && v % entranceSpacing == half) chosen.push_back(p);
+                double dist = (u - cu) * (u - cu) + (v - cv) * (v - cv);
+                if (dist < best) {
+                    best = dist;
+                    central = p;
+                }
+            }
+            if (chosen.empty()) chosen.push_back(central);
+
+            for (int p : chosen) {
+                int from = nodeFor(cellAt(p % su, p / su, 0), cluster);
+                int to = nodeFor(cellAt(p % su, p / su, 1), neighbor);
+                nodes[(size_t)from].edges.push_back({to, kStepStraight * gridStep});
+                nodes[(size_t)to].edges.push_back({from, kStepStraight * gridStep});
+            }
+        }
+    }
+
+    // cost between every pair of entrances of one cluster; touches only this
+    // cluster's nodes, so clusters can be linked in parallel
+    void linkCluster(int cluster, LocalSearch& ws) {
+        const vector<int>& members = clusterNodes[(size_t)cluster];
+        ws.loaded = -1;
+        vector<int> targets;
+        vector<double> costs;
+        for (size_t a = 0; a + 1 < members.size(); a++) {
+            targets.clear();
+            for (size_t c = a + 1; c < members.size(); c++) targets.push_back(nodes[(size_t)members[c]].cell);
+            clusterCosts(ws, cluster, nodes[(size_t)members[a]].cell, targets, costs);
+            for (size_t c = a + 1; c < members.size(); c++) {
+                double cost = costs[c - a - 1];
+                if (cost == numeric_limits<double>::infinity()) continue;
+                nodes[(size_t)members[a]].edges.push_back({members[c], cost});
+                nodes[(size_t)members[c]].edges.push_back({members[a], cost});
+            }
+        }
+    }
+
+    // nearest free lattice cell within one cell of p (-1 if none)
+    int nearestFreeCell(const Vector3D& p) const {
+        int ci = (int)floor(p.getX() / gridStep + 0.5);
+        int cj = (int)floor(p.getY() / gridStep + 0.5);
+        int ck = (int)floor(p.getZ() / gridStep + 0.5);
+        if (!grid.isBlocked(ci, cj, ck)) return cellIndex(ci, cj, ck);
+        int bestCell = -1;
+        double best = numeric_limits<double>::infinity();
+        for (const NeighborOffset& o : kNeighborOffsets) {
+            int i = ci + o.dx, j = cj + o.dy, k = ck + o.dz;
+            if (grid.isBlocked(i, j, k)) continue;
+            double dist = grid.samplePoint(i, j, k).distanceTo(p);
+            if (dist < best) {
+                best = dist;
+                bestCell = cellIndex(i, j, k);
+            }
+        }
+        return bestCell;
+    }
+
+    // append the in-cluster path from -> to (from itself excluded)
+    bool refineHop(int from, int to, vector<int>& cells) {
+        int cluster = clusterOf(from);
+        if (clusterOf(to) != cluster) {     // crossing a face: cells are adjacent
+            cells.push_back(to);
+            return true;
+        }
+        if (diagonalWalk(from, to, &cells)) return true;
+        if (!searchBox(querySearch, cluster, from, to, nullptr)) return false;
+        Box b = boxOf(cluster);
+        int i, j, k;
+        cellCoords(to, i, j, k);
+        size_t mark = cells.size();
+        for (int l = b.local(i, j, k); querySearch.parent[(size_t)l] != -1; l = querySearch.parent[(size_t)l]) {
+            b.coords(l, i, j, k);
+            cells.push_back(cellIndex(i, j, k));
+        }
+        reverse(cells.begin() + (long)mark, cells.end());
+        return true;
+    }
+
+    // lattice cells from start to goal, both included
+    bool planCells(int start, int goal, vector<int>& cells) {
+        int startCluster = clusterOf(start), goalCluster = clusterOf(goal);
+        cells.assign(1, start);
+        if (startCluster == goalCluster && refineHop(start, goal, cells)) return true;
+
+        // temporary links: start -> entrances of its cluster, entrances -> goal
+        const vector<int>& exits = clusterNodes[(size_t)startCluster];
+        const vector<int>& entries = clusterNodes[(size_t)goalCluster];
+        vector<Edge> startLinks;
+        vector<int> targets;
+        vector<double> costs;
+        for (int n : exits) targets.push_back(nodes[(size_t)n].cell);
+        clusterCosts(querySearch, startCluster, start, targets, costs);
+        for (size_t t = 0; t < exits.size(); t++) {
+            if (costs[t] != numeric_limits<double>::infinity()) startLinks.push_back({exits[t], costs[t]});
+        }
+        targets.clear();
+        for (int n : entries) targets.push_back(nodes[(size_t)n].cell);
+        clusterCosts(querySearch, goalCluster, goal, targets, costs);
+        for (size_t t = 0; t < entries.size(); t++) goalLink[(size_t)entries[t]] = costs[t];
+
+        // abstract A*: ids are node indices, plus startId and goalId
+        int startId = (int)nodes.size(), goalId = startId + 1;
+        fill(abstractG.begin(), abstractG.end(), numeric_limits<double>::infinity());
+        fill(abstractParent.begin(), abstractParent.end(), -1);
+        abstractOpen.clear();
+        abstractG[(size_t)startId] = 0;
+        abstractOpen.push(startId, heuristic(start, goal));
+        lastStats.notePush(abstractOpen.size());
+
+        bool found = false;
+        while (!abstractOpen.empty()) {
+            int cur = abstractOpen.pop();
+            lastStats.expansions++;
+            if (cur == goalId) {
+                found = true;
+                break;
+            }
+            auto relax = [&](int to, double cost) {
+                double newG = abstractG[(size_t)cur] + cost;
+                if (newG >= abstractG[(size_t)to]) return;
+                abstractG[(size_t)to] = newG;
+                abstractParent[(size_t)to] = cur;
+                double f = newG + (to == goalId ? 0 : heuristic(nodes[(size_t)to].cell, goal));
+                if (abstractOpen.contains(to)) {
+                    abstractOpen.decreaseKey(to, f);
+                    lastStats.decreaseKeys++;
+                } else {
+                    abstractOpen.push(to, f);
+                    lastStats.notePush(abstractOpen.size());
+                }
+            };
+            if (cur == startId) {
+                for (const Edge& e : startLinks) relax(e.to, e.cost);
+                continue;
+            }
+            for (const Edge& e : nodes[(size_t)cur].edges) relax(e.to, e.cost);
+            if (goalLink[(size_t)cur] != numeric_limits<double>::infinity()) relax(goalId, goalLink[(size_t)cur]);
+        }
+        for (int n : entries) goalLink[(size_t)n] = numeric_limits<double>::infinity();
+        if (!found) return false;
+
+        vector<int> hops;
+        for (int id = abstractParent[(size_t)goalId]; id != startId; id = abstractParent[(size_t)id]) {
+            hops.push_back(nodes[(size_t)id].cell);
+        }
+        reverse(hops.begin(), hops.end());
+        hops.push_back(goal);
+        int from = start;
+        for (int cell : hops) {
+            if (cell != from && !refineHop(from, cell, cells)) return false;
+            from = cell;
+        }
+        return true;
+    }
+
+public:
+    // the abstract graph is built on buildThreads workers (<= 1 builds inline)
+    HierarchicalPathFinder(const Map3D* m, double step = 1.0, int clusterCells = 16, int clusterLayers = 0,
+                           int spacing = 8, int buildThreads = (int)thread::hardware_concurrency())
+        : map(m), gridStep(step), clusterSize(max(2, clusterCells)), clusterHeight(max(0, clusterLayers)),
+          entranceSpacing(max(1, spacing)), nx(0), ny(0), nz(0), ccx(0), ccy(0), ccz(0), built(false),
+          builtRevision(0), pool(buildThreads), buildSearch((size_t)pool.size()) {}
+
+    // Bake the lattice and build the abstract graph. Called by findPath when
+    // the map has changed; call it up front to keep it off the first query.
+    void build() {
+        auto began = chrono::steady_clock::now();
+        grid.reset(map->getWidth(), map->getDepth(), map->getHeight(), gridStep, 0.5, Vector3D(0, 0, 0));
+        grid.bake(map->getObstacles());
+        nx = grid.getSizeX();
+        ny = grid.getSizeY();
+        nz = grid.getSizeZ();
+        int h = clusterHeight > 0 ? clusterHeight : max(1, nz);
+        ccx = (nx + clusterSize - 1) / clusterSize;
+        ccy = (ny + clusterSize - 1) / clusterSize;
+        ccz = (nz + h - 1) / h;
+        int clusters = ccx * ccy * ccz;
+
+        nodes.clear();
+        nodeOfCell.clear();
+        querySearch.loaded = -1;
+        clusterNodes.assign((size_t)clusters, vector<int>());
+        for (int c = 0; c < clusters; c++) {
+            for (int axis = 0; axis < 3; axis++) addEntrances(c, axis);
+        }
+        pool.parallelFor((size_t)clusters, [&](size_t c, int worker) {
+            linkCluster((int)c, buildSearch[(size_t)worker]);
+        });
+
+        abstractG.assign(nodes.size() + 2, 0);
+        abstractParent.assign(nodes.size() + 2, -1);
+        goalLink.assign(nodes.size(), numeric_limits<double>::infinity());
+        built = true;
+        builtRevision = map->getRevision();
+
+        hierarchy.clusters = clusters;
+        hierarchy.entrances = (int)nodes.size();
+        hierarchy.edges = 0;
+        hierarchy.memoryBytes = grid.getMemoryBytes() + nodes.capacity() * sizeof(Node);
+        for (const Node& n : nodes) {
+            hierarchy.edges += (long)n.edges.size();
+            hierarchy.memoryBytes += n.edges.capacity() * sizeof(Edge);
+        }
+        hierarchy.builds++;
+        hierarchy.buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - began).count();
+    }
+
+    bool isBuilt() const { return built && builtRevision == map->getRevision(); }
+    const HierarchyStats& getHierarchyStats() const { return hierarchy; }
+    // abstract-graph expansions; cluster-local refinement is in getLastLocalExpansions
+    const SearchStats& getLastStats() const { return lastStats; }
+    long getLastLocalExpansions() const { return querySearch.expansions; }
+
+    vector<Vector3D> findPath(const Vector3D& start, const Vector3D& end) override {
+        vector<Vector3D> path;
+        lastStats.reset();
+        querySearch.expansions = 0;
+
+        // Quick check for direct path
+        if (map->isSegmentClear(start, end)) {
+            path.push_back(start);
+            path.push_back(end);
+            return path;
+        }
+        if (!isBuilt()) build();
+
+        int startCell = nearestFreeCell(start), goalCell = nearestFreeCell(end);
+        vector<int> cells;
+        if (startCell < 0 || goalCell < 0 || !planCells(startCell, goalCell, cells)) {
+            return safeAltitudePath(map, start, end);
+        }
+        path.push_back(start);
+        for (int cell : cells) path.push_back(positionOf(cell));
+        path.push_back(end);
+        return smoothPathOnMap(map, path);
+    }
+};
+
+#endif
@@ -0,0 +1,106 @@
+// IndexedHeap.h - 4-ary min-heap over integer ids with decrease-key
+#ifndef INDEXEDHEAP_H
+#define INDEXEDHEAP_H
+
+#include <vector>
+#include <cstddef>
+using namespace std;
+
+// open-list entry: priority plus the index of the pooled node it refers to
+struct OpenEntry {
+    double f;
+    int node;
+
+    OpenEntry(double priority = 0, int idx = -1) : f(priority), node(idx) {}
+
+    bool operator>(const OpenEntry& other) const { return f > other.f; }
+};
+
+// Each id is in the heap at most once; position[] maps id -> heap slot so an
+// improved priority is fixed in place instead of pushing a duplicate.
+// A 4-ary layout halves the tree depth and keeps siblings in one cache line.
+class IndexedHeap {
+private:
+    enum { kArity = 4 };
+    vector<OpenEntry> heap;
+    vector<int> position;   // -1 when the id is not in the heap
+
+    void place(size_t slot, const OpenEntry& e) {
+        heap[slot] = e;
+        position[e.node] = (int)slot;
+    }
+
+    void siftUp(size_t slot) {
+        OpenEntry e = heap[slot];
+        while (slot > 0) {
+            size_t parentSlot = (slot - 1) / kArity;
+            if (!(heap[parentSlot].f > e.f)) break;
+            place(slot, heap[parentSlot]);
+            slot = parentSlot;
+        }
+        place(slot, e);
+    }
+
+    void siftDown(size_t slot) {
+        OpenEntry e = heap[slot];
+        size_t n = heap.size();
+        while (true) {
+            size_t first = slot * kArity + 1;
+            if (first >= n) break;
+            size_t last = first + kArity < n ? first + kArity : n;
+            size_t best = first;
+            for (size_t c = first + 1; c < last; c++) {
+                if (heap[best].f > heap[c].f) best = c;
+            }
+            if (!(e.f > heap[best].f)) break;
+            place(slot, heap[best]);
+            slot = best;
+        }
+        place(slot, e);
+    }
+
+public:
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+
+    bool contains(int id) const {
+        return id >= 0 && id < (int)position.size() && position[id] != -1;
+    }
+
+    void push(int id, double priority) {
+        if (id >= (int)position.size()) position.resize(id + 1, -1);
+        heap.push_back(OpenEntry(priority, id));
+        siftUp(heap.size() - 1);
+    }
+
+    // lower the priority of an id already in the heap
+    void decreaseKey(int id, double priority) {
+        size_t slot = (size_t)position[id];
+        heap[slot].f = priority;
+        siftUp(slot);
+    }
+
+    double topPriority() const { return heap.front().f; }
+    int top() const { return heap.front().node; }
+
+    int pop() {
+        int id = heap.front().node;
+        position[id] = -1;
+        OpenEntry last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            position[last.node] = 0;
+            siftDown(0);
+        }
+        return id;
+    }
+
+    // O(entries still queued); positions of popped ids are already -1
+    void clear() {
+        for (const auto& e : heap) position[e.node] = -1;
+        heap.clear();
+    }
+};
+
+#endif
@@ -0,0 +1,452 @@
+// JumpPointFinder.h - Jump point search over the PathFinder3D lattice
+#ifndef JUMPPOINTFINDER_H
+#define JUMPPOINTFINDER_H
+
+#include "Common.h"
+#include "Map.h"
+#include "PathFinder.h"
+#include "GridPathFinder.h"
+#include "IndexedHeap.h"
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+using namespace std;
+
+// position of an offset in kNeighborOffsets
+inline int neighborIndex(int dx, int dy, int dz) {
+    int t = (dx + 1) * 9 + (dy + 1) * 3 + (dz + 1);
+    return t < 13 ? t : t - 1;
+}
+
+// set bits in a neighbour mask (portable; MSVC has no __builtin_popcount)
+inline int maskBits(uint32_t m) {
+    int bits = 0;
+    for (; m; m &= m - 1) bits++;
+    return bits;
+}
+
+// Pruning rules per arrival direction d and neighbour e, as masks over the
+// 26 neighbours of the node. A neighbour that is not natural may be skipped
+// while one of its detours is entirely free: a path from the previous node
+// that avoids this node and is either shorter, or as short and takes its
+// more diagonal move first (the canonical order the jumps follow). Equal
+// costs always mean the same mix of move types, since 1, sqrt 2 and sqrt 3
+// are independent.
+struct JumpRules {
+    uint32_t natural[26];
+    vector<uint32_t> detours[26][26];
+
+    static int axes(const NeighborOffset& o) { return (o.dx != 0) + (o.dy != 0) + (o.dz != 0); }
+
+    JumpRules() {
+        for (int d = 0; d < 26; d++) {
+            const NeighborOffset& a = kNeighborOffsets[d];
+            natural[d] = 0;
+            for (int e = 0; e < 26; e++) {
+                const NeighborOffset& b = kNeighborOffsets[e];
+                if ((!b.dx || b.dx == a.dx) && (!b.dy || b.dy == a.dy) && (!b.dz || b.dz == a.dz)) {
+                    natural[d] |= 1u << e;
+                    continue;
+                }
+                int order[2] = {axes(a), axes(b)};
+                int moves[3];
+                collect(d, e, -a.dx, -a.dy, -a.dz, b, 0, a.cost + b.cost, order, moves, 0, 0);
+                // keep only minimal detours
+                vector<uint32_t>& list = detours[d][e];
+                sort(list.begin(), list.end(), [](uint32_t x, uint32_t y) {
+                    return maskBits(x) < maskBits(y);
+                });
+                vector<uint32_t> minimal;
+                for (uint32_t m : list) {
+                    bool covered = false;
+                    for (uint32_t k : minimal) covered = covered || (k & m) == k;
+                    if (!covered) minimal.push_back(m);
+                }
+                list.swap(minimal);
+            }
+        }
+    }
+
+    // paths inside the 3x3x3 block from (x, y, z) to target, never through the centre
+    void collect(int d, int e, int x, int y, int z, const NeighborOffset& target, double cost, double limit,
+                 const int order[2], int moves[3], int depth, uint32_t through) {
+        if (depth == 3) return;     // 3 straight moves already cost more than any pair beats
+        for (const NeighborOffset& o : kNeighborOffsets) {
+            int nx = x + o.dx, ny = y + o.dy, nz = z + o.dz;
+            if (nx < -1 || nx > 1 || ny < -1 || ny > 1 || nz < -1 || nz > 1) continue;
+            if (!nx && !ny && !nz) continue;
+            double c = cost + o.cost;
+            if (c > limit + 1e-9) continue;
+            moves[depth] = axes(o);
+            if (nx == target.dx && ny == target.dy && nz == target.dz) {
+                bool tie = c > limit - 1e-9;
+                if (!tie || (depth == 1 && (moves[0] > order[0] || (moves[0] == order[0] && moves[1] > order[1])))) {
+                    detours[d][e].push_back(through);
+                }
+                continue;
+            }
+            uint32_t bit = 1u << neighborIndex(nx, ny, nz);
+            if (through & bit) continue;
+            collect(d, e, nx, ny, nz, target, c, limit, order, moves, depth + 1, through | bit);
+        }
+    }
+};
+
+inline const JumpRules& jumpRules() {
+    static const JumpRules rules;
+    return rules;
+}
+
+// Jump point search (JPS) on the lattice PathFinder3D and GridPathFinder use:
+// anchored at the start, gridStep apart, 26-connected, a cell is usable when
+// Map3D::isBlocked (margin 0.5) says so, and the same goal test.
+// A node reached along direction d only continues along its natural
+// directions (d with some axes dropped) plus any forced neighbours: cells
+// that every detour allowed by JumpRules would have to pass through a
+// blocked cell to reach. Moves run in a straight line and only cells where
+// that set changes (a forced neighbour, the goal area, or for a diagonal a
+// component direction that reaches one) enter the open set. Path costs
+// match A* on the same lattice.
+class JumpPointFinder : public IPathFinder {
+private:
+    // per-cell bits, filled lazily so each cell is tested against the map once
+    static const uint8_t kKnown = 1, kBlocked = 2, kNearKnown = 4, kNear = 8, kClosed = 16;
+    static const uint32_t kAllNeighbors = (1u << 26) - 1;
+    static const int kMaxRun = 32767;
+
+    const Map3D* map;
+    double gridStep;
+    int maxIterations;
+
+    GridLattice lattice;
+    const VoxelGrid* occupancy;     // non-null when the baked bitmap shares this query's lattice
+    Vector3D goal;
+    int goalI, goalJ, goalK;        // nearest cell to the goal
+    // Workspace kept across queries. Map-derived data (cell bits, neighbour
+    // masks, straight runs) is listed in 'touched' and stays valid while the
+    // lattice and map revision are unchanged, so repeat queries on the same
+    // map skip most of the scanning; search data is listed in 'visited'.
+    vector<uint8_t> cellState;
+    vector<uint32_t> neighborMask;  // free neighbours of cells next to an obstacle
+    // per cell and straight direction: steps to the next cell with a forced
+    // neighbour (> 0) or into a wall (< 0); 0 = not walked yet
+    vector<int16_t> straightRun;
+    vector<int> rayCells;
+    vector<double> gScore;
+    vector<int> parent;
+    vector<int> touched;
+    vector<int> visited;
+    bool cacheValid;
+    unsigned long cachedRevision;
+    IndexedHeap openSet;
+    SearchStats lastStats;
+    long lastScanned;
+
+    void resetSearch(bool keepMapData) {
+        for (int cell : visited) {
+            gScore[cell] = numeric_limits<double>::infinity();
+            parent[cell] = -1;
+            cellState[cell] &= (uint8_t)~kClosed;
+        }
+        visited.clear();
+        if (!keepMapData) {
+            for (int cell : touched) {
+                cellState[cell] = 0;
+                neighborMask[cell] = 0;
+                fill(straightRun.begin() + (long)cell * 6, straightRun.begin() + (long)cell * 6 + 6, 0);
+            }
+            touched.clear();
+        }
+        openSet.clear();
+        size_t n = (size_t)lattice.cellCount();
+        if (cellState.size() < n) {
+            cellState.resize(n, 0);
+            neighborMask.resize(n, 0);
+            straightRun.resize(n * 6, 0);
+            gScore.resize(n, numeric_limits<double>::infinity());
+            parent.resize(n, -1);
+        }
+    }
+
+    uint8_t& state(int cell) {
+        uint8_t& s = cellState[cell];
+        if (!s) {
+            touched.push_back(cell);
+            int i, j, k;
+            lattice.coords(cell, i, j, k);
+            bool blocked = occupancy ? occupancy->isBlocked(i, j, k) : map->isBlocked(lattice.position(i, j, k));
+            s = blocked ? kKnown | kBlocked : kKnown;
+        }
+        return s;
+    }
+
+    bool isFree(int i, int j, int k) {
+        return lattice.inBounds(i, j, k) && !(state(lattice.index(i, j, k)) & kBlocked);
+    }
+
+    // free neighbours of a cell as a mask over kNeighborOffsets (the lattice edge counts as blocked)
+    uint32_t freeNeighbors(int i, int j, int k) {
+        uint32_t mask = 0;
+        for (int n = 0; n < 26; n++) {
+            const NeighborOffset& o = kNeighborOffsets[n];
+            if (isFree(i + o.dx, j + o.dy, k + o.dz)) mask |= 1u << n;
+        }
+        return mask;
+    }
+
+    // forced neighbours of a cell entered along direction d
+    uint32_t forcedNeighbors(int i, int j, int k, int d) {
+        int cell = lattice.index(i, j, k);
+        uint8_t& s = state(cell);
+        if (!(s & kNearKnown)) {
+            uint32_t free = freeNeighbors(i, j, k);
+            s |= free == kAllNeighbors ? kNearKnown : kNearKnown | kNear;
+            neighborMask[cell] = free;
+        }
+        if (!(s & kNear)) return 0;
+        uint32_t free = neighborMask[cell];
+        const JumpRules& rules = jumpRules();
+        uint32_t forced = 0;
+        for (int e = 0; e < 26; e++) {
+            if ((rules.natural[d] >> e & 1) || !(free >> e & 1)) continue;
+            bool detour = false;
+            for (uint32_t m : rules.detours[d][e]) {
+                if ((m & ~free) == 0) {
+                    detour = true;
+                    break;
+                }
+            }
+            if (!detour) forced |= 1u << e;
+        }
+        return forced;
+    }
+
+    bool inGoalArea(int i, int j, int k) const {
+        if (abs(i - goalI) > 2 || abs(j - goalJ) > 2 || abs(k - goalK) > 2) return false;
+        return lattice.position(i, j, k).distanceTo(goal) < gridStep * 1.5;
+    }
+
+    // slot of a straight direction in straightRun, -1 for diagonals
+    static int straightSlot(int d) {
+        const NeighborOffset& o = kNeighborOffsets[d];
+        if ((o.dx != 0) + (o.dy != 0) + (o.dz != 0) != 1) return -1;
+        return o.dx ? (o.dx > 0) : o.dy ? 2 + (o.dy > 0) : 4 + (o.dz > 0);
+    }
+
+    // Walk a straight line until a wall or a forced neighbour. The answer for
+    // every cell passed on the way is the tail of this one, so it is cached
+    // for all of them: diagonal jumps re-ask the same rows constantly.
+    int walkStraight(int i, int j, int k, int d) {
+        const NeighborOffset& o = kNeighborOffsets[d];
+        int slot = straightSlot(d);
+        int first = lattice.index(i, j, k);
+        rayCells.clear();
+        int run = 0;
+        for (int t = 1;; t++) {
+            i += o.dx;
+            j += o.dy;
+            k += o.dz;
+            lastScanned++;
+            if (!isFree(i, j, k)) {
+                run = -t;
+                break;
+            }
+            if (forcedNeighbors(i, j, k, d) || t == kMaxRun) {   // a capped run just adds a jump point
+                run = t;
+                break;
+            }
+            // the rest of the line is known from an earlier walk
+            int cell = lattice.index(i, j, k);
+            int cached = straightRun[(size_t)cell * 6 + slot];
+            if (cached != 0 && abs(cached) + t <= kMaxRun) {
+                run = cached > 0 ? cached + t : cached - t;
+                break;
+            }
+            rayCells.push_back(cell);
+        }
+        straightRun[(size_t)first * 6 + slot] = (int16_t)run;
+        for (size_t u = 0; u < rayCells.size(); u++) {
+            int left = abs(run) - (int)(u + 1);
+            straightRun[(size_t)rayCells[u] * 6 + slot] = (int16_t)(run > 0 ? left : -left);
+        }
+        return run;
+    }
+
+    // first step in [1, limit] at which a straight ray enters the goal area (0 = none)
+    int goalStepOnRay(int i, int j, int k, const NeighborOffset& o, int limit) const {
+        int along;
+        if (o.dx) {
+            if (abs(j - goalJ) > 2 || abs(k - goalK) > 2) return 0;
+            along = (goalI - i) * o.dx;
+        } else if (o.dy) {
+            if (abs(i - goalI) > 2 || abs(k - goalK) > 2) return 0;
+            along = (goalJ - j) * o.dy;
+        } else {
+            if (abs(i - goalI) > 2 || abs(j - goalJ) > 2) return 0;
+            along = (goalK - k) * o.dz;
+        }
+        for (int t = max(1, along - 2); t <= min(limit, along + 2); t++) {
+            if (inGoalArea(i + t * o.dx, j + t * o.dy, k + t * o.dz)) return t;
+        }
+        return 0;
+    }
+
+    // Move (i, j, k) to the first jump point along direction d; false if the
+    // line runs into an obstacle or the edge first.
+    bool jump(int& i, int& j, int& k, int d) {
+        const NeighborOffset& o = kNeighborOffsets[d];
+        int axes = (o.dx != 0) + (o.dy != 0) + (o.dz != 0);
+        if (axes == 1) {
+            int slot = straightSlot(d);
+            int run = straightRun[(size_t)lattice.index(i, j, k) * 6 + slot];
+            if (run == 0) run = walkStraight(i, j, k, d);
+            int steps = abs(run);
+            int t = goalStepOnRay(i, j, k, o, run > 0 ? steps : steps - 1);
+            if (t == 0 && run < 0) return false;
+            if (t == 0) t = steps;
+            i += t * o.dx;
+            j += t * o.dy;
+            k += t * o.dz;
+            return true;
+        }
+        while (true) {
+            i += o.dx;
+            j += o.dy;
+            k += o.dz;
+            lastScanned++;
+            if (!isFree(i, j, k)) return false;
+            if (inGoalArea(i, j, k) || forcedNeighbors(i, j, k, d)) return true;
+            // every proper component direction of a diagonal
+            for (int sx = 0; sx <= (o.dx != 0); sx++) {
+                for (int sy = 0; sy <= (o.dy != 0); sy++) {
+                    for (int sz = 0; sz <= (o.dz != 0); sz++) {
+                        if (sx + sy + sz == 0 || sx + sy + sz == axes) continue;
+                        int ji = i, jj = j, jk = k;
+                        if (jump(ji, jj, jk, neighborIndex(sx * o.dx, sy * o.dy, sz * o.dz))) return true;
+                    }
+                }
+            }
+        }
+    }
+
+    void relax(int from, int to, double newG, const Vector3D& end) {
+        if (newG >= gScore[to]) return;
+        if (gScore[to] == numeric_limits<double>::infinity()) visited.push_back(to);
+        gScore[to] = newG;
+        parent[to] = from;
+        double f = newG + lattice.position(to).distanceTo(end);
+        if (openSet.contains(to)) {
+            openSet.decreaseKey(to, f);
+            lastStats.decreaseKeys++;
+        } else {
+            openSet.push(to, f);
+            lastStats.notePush(openSet.size());
+        }
+    }
+
+    static int sign(int v) { return (v > 0) - (v < 0); }
+
+public:
+    JumpPointFinder(const Map3D* m, double step = 1.0)
+        : map(m), gridStep(step), maxIterations(10000), occupancy(nullptr), cacheValid(false), cachedRevision(0),
+          lastScanned(0) {}
+
+    // jump points expanded before giving up (flat A* counts every cell)
+    void setMaxIterations(int n) { maxIterations = n; }
+    const SearchStats& getLastStats() const { return lastStats; }
+    // cells walked by jump scans in the last query
+    long getLastScanned() const { return lastScanned; }
+
+    vector<Vector3D> findPath(const Vector3D& start, const Vector3D& end) override {
+        vector<Vector3D> path;
+        lastStats.reset();
+        lastScanned = 0;
+
+        // Quick check for direct path
+        if (map->isSegmentClear(start, end)) {
+            path.push_back(start);
+            path.push_back(end);
+            return path;
+        }
+
+        GridLattice previous = lattice;
+        lattice = GridLattice(*map, start, gridStep);
+        int startCell = lattice.cellOf(start);
+        if (startCell < 0) return safeAltitudePath(map, start, end);
+        bool sameLattice = cacheValid && cachedRevision == map->getRevision() && lattice.nx == previous.nx &&
+                           lattice.ny == previous.ny && lattice.nz == previous.nz &&
+                           fabs(lattice.originX - previous.originX) < 1e-9 &&
+                           fabs(lattice.originY - previous.originY) < 1e-9 &&
+                           fabs(lattice.originZ - previous.originZ) < 1e-9;
+        resetSearch(sameLattice);
+        cacheValid = true;
+        cachedRevision = map->getRevision();
+        goal = end;
+        goalI = (int)floor((end.getX() - lattice.originX) / gridStep + 0.5);
+        goalJ = (int)floor((end.getY() - lattice.originY) / gridStep + 0.5);
+        goalK = (int)floor((end.getZ() - lattice.originZ) / gridStep + 0.5);
+
+        occupancy = lattice.matchingOccupancy(*map);
+
+        state(startCell);
+        gScore[startCell] = 0;
+        visited.push_back(startCell);
+        openSet.push(startCell, start.distanceTo(end));
+        lastStats.notePush(openSet.size());
+
+        int iterations = 0;
+        while (!openSet.empty() && iterations < maxIterations) {
+            iterations++;
+            int cell = openSet.pop();
+            cellState[cell] |= kClosed;
+            lastStats.expansions++;
+
+            int ci, cj, ck;
+            lattice.coords(cell, ci, cj, ck);
+            Vector3D currentPos = lattice.position(ci, cj, ck);
+
+            if (currentPos.distanceTo(end) < gridStep * 1.5) {
+                lastStats.pathCost = gScore[cell] + currentPos.distanceTo(end);
+                // jump points plus the cells between them, as A* would return
+                for (int idx = cell; idx != -1; idx = parent[idx]) {
+                    int i, j, k, pi, pj, pk;
+                    lattice.coords(idx, i, j, k);
+                    path.push_back(lattice.position(i, j, k));
+                    if (parent[idx] == -1) break;
+                    lattice.coords(parent[idx], pi, pj, pk);
+                    int dx = sign(pi - i), dy = sign(pj - j), dz = sign(pk - k);
+                    for (i += dx, j += dy, k += dz; i != pi || j != pj || k != pk; i += dx, j += dy, k += dz) {
+                        path.push_back(lattice.position(i, j, k));
+                    }
+                }
+                reverse(path.begin(), path.end());
+                path.push_back(end);
+                return smoothPathOnMap(map, path, &lastStats.segmentChecks);
+            }
+
+            // natural and forced directions from the way we came; all 26 at the start
+            uint32_t directions = kAllNeighbors;
+            if (parent[cell] != -1) {
+                int pi, pj, pk;
+                lattice.coords(parent[cell], pi, pj, pk);
+                int d = neighborIndex(sign(ci - pi), sign(cj - pj), sign(ck - pk));
+                directions = jumpRules().natural[d] | forcedNeighbors(ci, cj, ck, d);
+            }
+            for (int e = 0; e < 26; e++) {
+                if (!(directions >> e & 1)) continue;
+                int ji = ci, jj = cj, jk = ck;
+                if (!jump(ji, jj, jk, e)) continue;
+                int next = lattice.index(ji, jj, jk);
+                if (cellState[next] & kClosed) continue;
+                int steps = max(abs(ji - ci), max(abs(jj - cj), abs(jk - ck)));
+                relax(cell, next, gScore[cell] + steps * kNeighborOffsets[e].cost * gridStep, end);
+            }
+        }
+
+        // fly high above obstacles
+        return safeAltitudePath(map, start, end);
+    }
+};
+
+#endif
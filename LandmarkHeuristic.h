@@ -0,0 +1,281 @@
+// LandmarkHeuristic.h - Precomputed landmark (ALT) distance table for A* on the dense lattice
+#ifndef LANDMARKHEURISTIC_H
+#define LANDMARKHEURISTIC_H
+
+#include "Common.h"
+#include "Map.h"
+#include "PathFinder.h"
+#include "GridLattice.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <fstream>
+#include <chrono>
+using namespace std;
+
+constexpr uint32_t kLandmarkMagic = 0x4D4C4644;     // "DFLM"
+constexpr uint32_t kLandmarkVersion = 1;
+constexpr int kMaxLandmarks = 64;                   // build() clamps, load() rejects larger files
+
+// per-goal bounds, filled by LandmarkHeuristic::prepareGoal
+struct LandmarkGoal {
+    vector<double> lo, hi;      // nearest / farthest goal cell seen from each landmark
+    double offset;              // shortest hop from a goal cell to the off-lattice end
+
+    LandmarkGoal() : offset(0) {}
+};
+
+// Shortest lattice distances from a few landmark cells to every cell of one
+// map, for the A* lattice that GridPathFinder walks when its start lies on
+// it. By the triangle inequality |d(L, v) - d(L, c)| never exceeds the cost
+// from v to goal cell c, so the largest such bound over the landmarks is an
+// admissible and consistent heuristic that sees around buildings, where the
+// straight-line distance does not. Landmarks are picked farthest-first, one
+// Dijkstra each; the table is stored as floats, cell-major so one query
+// reads a single cache line, and can be saved and loaded so it is built
+// once per map.
+class LandmarkHeuristic {
+private:
+    // float rounding of stored distances, taken off every bound
+    static constexpr double kFloatSlack = 2.5e-7;
+
+    GridLattice lattice;
+    int count;
+    vector<int> landmarks;
+    vector<float> dist;             // dist[cell * count + l], infinity when unreachable
+    const Map3D* source;
+    unsigned long sourceRevision;
+    double buildMs;
+
+    // Dijkstra over the free lattice cells (26-connected, kNeighborOffsets costs)
+    void distancesFrom(int sourceCell, const vector<uint8_t>& blocked, vector<double>& d) const {
+        typedef pair<double, int> Entry;
+        d.assign(blocked.size(), numeric_limits<double>::infinity());
+        vector<Entry> open;
+        d[sourceCell] = 0;
+        open.push_back({0.0, sourceCell});
+        while (!open.empty()) {
+            pop_heap(open.begin(), open.end(), greater<Entry>());
+            Entry current = open.back();
+            open.pop_back();
+            if (current.first > d[current.second]) continue;
+            int ci, cj, ck;
+            lattice.coords(current.second, ci, cj, ck);
+            for (const NeighborOffset& o : kNeighborOffsets) {
+                int ni = ci + o.dx, nj = cj + o.dy, nk = ck + o.dz;
+                if (!lattice.inBounds(ni, nj, nk)) continue;
+                int next = lattice.index(ni, nj, nk);
+                if (blocked[next]) continue;
+                double nd = current.first + o.cost * lattice.step;
+                if (nd >= d[next]) continue;
+                d[next] = nd;
+                open.push_back({nd, next});
+                push_heap(open.begin(), open.end(), greater<Entry>());
+            }
+        }
+    }
+
+    bool sameLattice(const GridLattice& other) const {
+        return lattice.nx == other.nx && lattice.ny == other.ny && lattice.nz == other.nz &&
+               fabs(lattice.step - other.step) < 1e-12 && fabs(lattice.originX - other.originX) < 1e-9 &&
+               fabs(lattice.originY - other.originY) < 1e-9 && fabs(lattice.originZ - other.originZ) < 1e-9;
+    }
+
+public:
+    LandmarkHeuristic() : count(0), source(nullptr), sourceRevision(0), buildMs(0) {}
+
+    // FNV-1a over the map bounds and obstacle boxes; ties a saved table to its map
+    static uint64_t mapFingerprint(const Map3D& map) {
+        uint64_t h = 1469598103934665603ULL;
+        auto mix = [&h](const void* data, size_t bytes) {
+            const unsigned char* p = (const unsigned char*)data;
+            for (size_t i = 0; i < bytes; i++) {
+                h ^= p[i];
+                h *= 1099511628211ULL;
+            }
+        };
+        int dims[3] = {map.getWidth(), map.getDepth(), map.getHeight()};
+        mix(dims, sizeof(dims));
+        for (const Obstacle& obs : map.getObstacles()) {
+            Vector3D p = obs.getPosition();
+            double box[6] = {p.getX(), p.getY(), p.getZ(), obs.getLength(), obs.getWidth(), obs.getHeight()};
+            mix(box, sizeof(box));
+        }
+        return h;
+    }
+
+    // lattice through 'anchor' (the origin by default: integer starts at step 1)
+    void build(const Map3D& map, int landmarkCount = 8, double step = 1.0, const Vector3D& anchor = Vector3D()) {
+        auto begin = chrono::steady_clock::now();
+        landmarkCount = min(landmarkCount, kMaxLandmarks);
+        lattice = GridLattice(map, anchor, step);
+        source = &map;
+        sourceRevision = map.getRevision();
+        size_t n = (size_t)lattice.cellCount();
+        landmarks.clear();
+        count = 0;
+
+        // same free test as GridPathFinder: the baked bitmap when it lines up
+        const VoxelGrid* voxels = lattice.matchingOccupancy(map);
+        vector<uint8_t> blocked(n);
+        int firstFree = -1;
+        for (size_t c = 0; c < n; c++) {
+            int i, j, k;
+            lattice.coords((int)c, i, j, k);
+            blocked[c] = voxels ? voxels->isBlocked(i, j, k) : map.isBlocked(lattice.position(i, j, k));
+            if (!blocked[c] && firstFree < 0) firstFree = (int)c;
+        }
+        if (firstFree < 0 || landmarkCount <= 0) {
+            dist.clear();
+            return;
+        }
+
+        // farthest-first: each landmark is the cell farthest from those chosen so far
+        vector<double> d, nearest;
+        distancesFrom(firstFree, blocked, d);
+        nearest.assign(n, numeric_limits<double>::infinity());
+        int next = (int)(max_element(d.begin(), d.end(), [](double a, double b) {
+            return (a == numeric_limits<double>::infinity() ? -1 : a) < (b == numeric_limits<double>::infinity() ? -1 : b);
+        }) - d.begin());
+        dist.assign(n * landmarkCount, numeric_limits<float>::infinity());
+        for (int l = 0; l < landmarkCount; l++) {
+            landmarks.push_back(next);
+            count = l + 1;
+            distancesFrom(next, blocked, d);
+            double farthest = -1;
+            for (size_t c = 0; c < n; c++) {
+                dist[c * landmarkCount + l] = (float)d[c];
+                nearest[c] = min(nearest[c], d[c]);
+                if (nearest[c] != numeric_limits<double>::infinity() && nearest[c] > farthest) {
+                    farthest = nearest[c];
+                    next = (int)c;
+                }
+            }
+            if (farthest <= 0) break;   // every reachable cell is already a landmark
+        }
+        if (count < landmarkCount) {
+            // compact the columns to the landmarks actually placed
+            vector<float> packed(n * count);
+            for (size_t c = 0; c < n; c++) {
+                copy(dist.begin() + c * landmarkCount, dist.begin() + c * landmarkCount + count,
+                     packed.begin() + c * count);
+            }
+            dist.swap(packed);
+        }
+        buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+    }
+
+    bool save(const string& path) const {
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out.is_open() || !source) return false;
+        uint32_t header[4] = {kLandmarkMagic, kLandmarkVersion, (uint32_t)count, 0};
+        double frame[4] = {lattice.originX, lattice.originY, lattice.originZ, lattice.step};
+        int32_t dims[4] = {lattice.nx, lattice.ny, lattice.nz, 0};
+        uint64_t fingerprint = mapFingerprint(*source);
+        out.write((const char*)header, sizeof(header));
+        out.write((const char*)frame, sizeof(frame));
+        out.write((const char*)dims, sizeof(dims));
+        out.write((const char*)&fingerprint, sizeof(fingerprint));
+        out.write((const char*)landmarks.data(), (streamsize)(landmarks.size() * sizeof(int)));
+        out.write((const char*)dist.data(), (streamsize)(dist.size() * sizeof(float)));
+        return (bool)out;
+    }
+
+    // false when the file is missing, corrupt or was built for a different map
+    bool load(const string& path, const Map3D& map) {
+        auto begin = chrono::steady_clock::now();
+        ifstream in(path, ios::binary);
+        if (!in.is_open()) return false;
+        uint32_t header[4];
+        double frame[4];
+        int32_t dims[4];
+        uint64_t fingerprint;
+        in.read((char*)header, sizeof(header));
+        in.read((char*)frame, sizeof(frame));
+        in.read((char*)dims, sizeof(dims));
+        in.read((char*)&fingerprint, sizeof(fingerprint));
+        if (!in || header[0] != kLandmarkMagic || header[1] != kLandmarkVersion || header[2] == 0 ||
+            header[2] > (uint32_t)kMaxLandmarks || !(frame[3] > 0) || fingerprint != mapFingerprint(map)) {
+            return false;
+        }
+        GridLattice expected(map, Vector3D(frame[0], frame[1], frame[2]), frame[3]);
+        if (expected.nx != dims[0] || expected.ny != dims[1] || expected.nz != dims[2]) return false;
+
+        // size the tables from the header only once the file is known to hold them
+        uint64_t cells = (uint64_t)expected.cellCount();
+        uint64_t need = header[2] * (sizeof(int) + cells * sizeof(float));
+        streamoff here = in.tellg();
+        in.seekg(0, ios::end);
+        streamoff end = in.tellg();
+        in.seekg(here);
+        if (here < 0 || end < here || (uint64_t)(end - here) < need) return false;
+
+        vector<int> loadedLandmarks(header[2]);
+        in.read((char*)loadedLandmarks.data(), (streamsize)(loadedLandmarks.size() * sizeof(int)));
+        if (!in) return false;
+        for (int id : loadedLandmarks) {
+            if (id < 0 || (uint64_t)id >= cells) return false;
+        }
+        vector<float> loadedDist((size_t)cells * header[2]);
+        in.read((char*)loadedDist.data(), (streamsize)(loadedDist.size() * sizeof(float)));
+        if (!in) return false;
+
+        lattice = expected;
+        count = (int)header[2];
+        landmarks.swap(loadedLandmarks);
+        dist.swap(loadedDist);
+        source = &map;
+        sourceRevision = map.getRevision();
+        buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+        return true;
+    }
+
+    // usable for a query on this map and lattice while the map is unchanged
+    bool matches(const Map3D& map, const GridLattice& queryLattice) const {
+        return count > 0 && source == &map && sourceRevision == map.getRevision() && sameLattice(queryLattice);
+    }
+
+    // Bounds over the cells the A* goal test accepts for 'end'; false if there are none.
+    bool prepareGoal(const Vector3D& end, LandmarkGoal& goal) const {
+        goal.lo.assign(count, numeric_limits<double>::infinity());
+        goal.hi.assign(count, -numeric_limits<double>::infinity());
+        goal.offset = numeric_limits<double>::infinity();
+        lattice.forEachGoalCell(end, [&](int cell, int, int, int, double toEnd) {
+            goal.offset = min(goal.offset, toEnd);
+            const float* d = &dist[(size_t)cell * count];
+            for (int l = 0; l < count; l++) {
+                if (d[l] == numeric_limits<float>::infinity()) continue;
+                goal.lo[l] = min(goal.lo[l], (double)d[l]);
+                goal.hi[l] = max(goal.hi[l], (double)d[l]);
+            }
+        });
+        return goal.offset != numeric_limits<double>::infinity();
+    }
+
+    // lower bound on the cost from a cell to the end (combine with the straight line)
+    inline double estimate(const LandmarkGoal& goal, int cell) const {
+        const float* d = &dist[(size_t)cell * count];
+        double best = 0;
+        for (int l = 0; l < count; l++) {
+            double dv = d[l];
+            // a cell cut off from a landmark shares no component with its goal cells
+            if (dv == numeric_limits<double>::infinity() || goal.lo[l] == numeric_limits<double>::infinity()) continue;
+            double bound = max(goal.lo[l] - dv, dv - goal.hi[l]) - kFloatSlack * (dv + goal.hi[l]);
+            best = max(best, bound);
+        }
+        return best + goal.offset;
+    }
+
+    int getLandmarkCount() const { return count; }
+    const vector<int>& getLandmarks() const { return landmarks; }
+    const GridLattice& getLattice() const { return lattice; }
+    // wall time of the last build() or load()
+    double getBuildMs() const { return buildMs; }
+    size_t memoryBytes() const { return dist.size() * sizeof(float) + landmarks.size() * sizeof(int); }
+};
+
+#endif
@@ -10,49 +10,12 @@
 #include <ctime>
 #include <iostream>
 #include <unordered_map>
+#include "MissionLog.h"
+#include "MissionWriter.h"
+#include "MissionStats.h"
 
 using namespace std;
 
-// Mission result structure
-struct MissionResult {
-    string droneId;
-    string startPos;
-    string endPos;
-    double distance;
-    double batteryUsed;
-    double duration;
-    string status;
-    string timestamp;
-    
-    string toCSV() const {
-        stringstream ss;
-        ss << droneId << "," << startPos << "," << endPos << ","
-           << fixed << setprecision(2) << distance << ","
-           << batteryUsed << "," << duration << "," << status << "," << timestamp;
-        return ss.str();
-    }
-    
-    static MissionResult fromCSV(const string& line) {
-        MissionResult result;
-        stringstream ss(line);
-        string token;
-        vector<string> tokens;
-        while (getline(ss, token, ',')) tokens.push_back(token);
-        
-        if (tokens.size() >= 8) {
-            result.droneId = tokens[0];
-            result.startPos = tokens[1];
-            result.endPos = tokens[2];
-            result.distance = stod(tokens[3]);
-            result.batteryUsed = stod(tokens[4]);
-            result.duration = stod(tokens[5]);
-            result.status = tokens[6];
-            result.timestamp = tokens[7];
-        }
-        return result;
-    }
-};
-
 // template class for generic data storage
 template<typename T>
 class DataStore {
@@ -76,130 +39,175 @@ public:
 };
 
 // file handling
+// Missions are stored in a binary columnar log next to the CSV path
+// (mission_log.csv -> mission_log.*.col). Reports map the columns and scan
+// them directly; an existing CSV log is imported the first time.
+// Writes go through a long-lived buffered writer (by default on its own
+// thread), so logMission never waits for the disk; reports flush it first.
+// Summary figures come from running aggregates kept in a sidecar snapshot
+// (mission_log.stats), so neither reports nor startup rescan the log.
 class MissionLogger {
 private:
     string logFile;
+    string logBase;
+    BufferedMissionWriter writer;
+    MissionStats stats;
     DataStore<MissionResult> missionStore;
     
     string getCurrentTimestamp() {
-        time_t now = time(0);
-        tm* ltm = localtime(&now);
-        stringstream ss;
-        ss << 1900 + ltm->tm_year << "-" 
-           << setfill('0') << setw(2) << 1 + ltm->tm_mon << "-"
-           << setw(2) << ltm->tm_mday << " "
-           << setw(2) << ltm->tm_hour << ":"
-           << setw(2) << ltm->tm_min << ":"
-           << setw(2) << ltm->tm_sec;
-        return ss.str();
+        return formatTimestamp(time(0));
+    }
+
+    static string baseName(const string& file) {
+        size_t dot = file.rfind(".csv");
+        return dot != string::npos && dot + 4 == file.size() ? file.substr(0, dot) : file;
+    }
+
+    string statsFile() const { return logBase + ".stats"; }
+
+    // Start from the snapshot and fold in any rows logged after it was taken
+    // (e.g. after a crash). A snapshot covering more rows than the log, or a
+    // missing one, means the log was replaced: recount everything.
+    void loadStats() {
+        ColumnarLogReader reader;
+        reader.open(logBase);
+        if (stats.load(statsFile()) && stats.rowCount() <= reader.size()) {
+            if (stats.rowCount() == reader.size()) return;
+            stats.addRows(reader, stats.rowCount());
+        } else {
+            stats.rebuild(reader);
+        }
+        stats.save(statsFile());
     }
     
 public:
-    MissionLogger(string file = "mission_log.csv") : logFile(file) {}
+    MissionLogger(string file = "mission_log.csv", const FlushPolicy& policy = FlushPolicy(),
+                  bool backgroundWriter = true)
+        : logFile(file), logBase(baseName(file)), writer(policy, backgroundWriter) {
+        if (!columnLogExists(logBase)) {
+            CSVScanReport report;
+            importMissionCSV(logFile, logBase, false, &report);
+            if (report.malformed > 0) {
+                const CSVIssue& first = report.issues[0];
+                cout << "Skipped " << report.malformed << " malformed row(s) in " << logFile
+                     << " (first: line " << first.line << ", field " << first.field + 1 << ", "
+                     << csvErrorName(first.error) << ")\n";
+            }
+        }
+        writer.open(logBase);
+        loadStats();
+    }
+
+    ~MissionLogger() {
+        flush();
+    }
     
     //write file
     void logMission(MissionResult& result) {
         result.timestamp = getCurrentTimestamp();
         missionStore.add(result);
-    //append file
-        ofstream file(logFile, ios::app);
-        if (file.is_open()) {
-            file << result.toCSV() << endl;
-            file.close();
-        }
+        stats.add(result);
+    //append columns (buffered; written by the flush policy)
+        writer.append(result);
+    }
+
+    // durability barrier: every mission logged so far is on disk, and the
+    // snapshot matches it
+    void flush() {
+        writer.flush();
+        stats.save(statsFile());
     }
     //read file
     vector<MissionResult> readAllMissions() {
         vector<MissionResult> missions;
-        ifstream file(logFile);
-        if (file.is_open()) {
-            string line;
-            while (getline(file, line)) {
-                if (!line.empty()) {
-                    missions.push_back(MissionResult::fromCSV(line));
-                }
+        writer.flush();
+        ColumnarLogReader reader;
+        if (reader.open(logBase)) {
+            missions.reserve(reader.size());
+            for (size_t i = 0; i < reader.size(); i++) {
+                missions.push_back(reader.row(i));
             }
-            file.close();
         }
         return missions;
     }
     
     // generate summary report
     void printSummary() {
-        auto missions = readAllMissions();
-        if (missions.empty()) {
+        size_t n = stats.rowCount();
+        if (n == 0) {
             cout << "No mission logs found.\n";
             return;
         }
         
-        double totalDist = 0, totalBattery = 0, totalTime = 0;
-        int successCount = 0;
-        unordered_map<string, int> droneUsage;
-        
-        for (const auto& m : missions) {
-            totalDist += m.distance;
-            totalBattery += m.batteryUsed;
-            totalTime += m.duration;
-            if (m.status == "Completed") successCount++;
-            droneUsage[m.droneId]++;
-        }
+        long successCount = stats.getStatusCount("Completed");
+        double totalDist = stats.getTotalDistance();
         
         cout << "\n========== MISSION SUMMARY ==========\n";
-        cout << "Total Missions: " << missions.size() << endl;
+        cout << "Total Missions: " << n << endl;
         cout << "Successful: " << successCount << " (" 
-             << (100.0 * successCount / missions.size()) << "%)\n";
+             << (100.0 * successCount / n) << "%)\n";
         cout << "Total Distance: " << fixed << setprecision(2) 
              << totalDist << " units\n";
-        cout << "Total Battery Used: " << totalBattery << "%\n";
-        cout << "Total Flight Time: " << totalTime << " seconds\n";
-        cout << "Avg Distance/Mission: " << totalDist / missions.size() << " units\n";
+        cout << "Total Battery Used: " << stats.getTotalBattery() << "%\n";
+        cout << "Total Flight Time: " << stats.getTotalTime() << " seconds\n";
+        cout << "Avg Distance/Mission: " << totalDist / n << " units\n";
         cout << "\nDrone Usage:\n";
-        for (const auto& p : droneUsage) {
-            cout << "  " << p.first << ": " << p.second << " missions\n";
+        for (const auto& d : stats.getDrones()) {
+            cout << "  " << d.droneId << ": " << d.missions << " missions\n";
+        }
+        cout << "\nStatus:\n";
+        for (const auto& s : stats.getStatusHistogram()) {
+            cout << "  " << s.first << ": " << s.second << "\n";
         }
         cout << "======================================\n";
     }
     
     // compare efficiency between drones
     void compareEfficiency() {
-        auto missions = readAllMissions();
-        if (missions.empty()) {
+        if (stats.rowCount() == 0) {
             cout << "No mission logs for comparison.\n";
             return;
         }
         
-        unordered_map<string, vector<double>> droneEfficiency;
-        
-        for (const auto& m : missions) {
-            if (m.distance > 0) {
-                double eff = m.batteryUsed / m.distance;
-                droneEfficiency[m.droneId].push_back(eff);
-            }
-        }
-        
         cout << "\n======= EFFICIENCY COMPARISON =======\n";
         cout << left << setw(15) << "Drone" 
              << setw(12) << "Missions" 
              << setw(15) << "Avg Batt/Unit" << endl;
         cout << string(42, '-') << endl;
         
-        for (const auto& p : droneEfficiency) {
-            double avgEff = 0;
-            for (double e : p.second) avgEff += e;
-            avgEff /= p.second.size();
-            
-            cout << left << setw(15) << p.first 
-                 << setw(12) << p.second.size()
-                 << fixed << setprecision(3) << avgEff << "%\n";
+        for (const auto& d : stats.getDrones()) {
+            if (d.effMissions == 0) continue;
+            cout << left << setw(15) << d.droneId 
+                 << setw(12) << d.effMissions
+                 << fixed << setprecision(3) << d.avgEfficiency() << "%\n";
         }
         cout << "=====================================\n";
     }
+
+    // map the log for column scans (analytics); flushes pending writes first
+    bool openReader(ColumnarLogReader& reader) {
+        writer.flush();
+        return reader.open(logBase);
+    }
+
+    // write the whole log in the CSV format (toCSV rows)
+    size_t exportCSV(const string& csvPath) {
+        writer.flush();
+        return exportMissionCSV(logBase, csvPath);
+    }
+
     //clear file
     void clearLogs() {
+        writer.reopen(true);
         ofstream file(logFile, ios::trunc);
         file.close();
         missionStore.clear();
+        stats.clear();
+        stats.save(statsFile());
     }
+
+    const string& getLogBase() const { return logBase; }
+    const MissionStats& getStats() const { return stats; }
 };
 
 #endif
\ No newline at end of file
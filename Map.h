@@ -3,6 +3,8 @@
 #define MAP_H
 
 #include "Common.h"
+#include "SpatialIndex.h"
+#include "VoxelGrid.h"
 #include <vector>
 #include <string>
 using namespace std;
@@ -12,17 +14,27 @@ private:
     int width, depth, height;
     vector<Obstacle> obstacles;
     string mapName;
+    unsigned long revision;   // bumped on every change so planners can drop stale results
+    ObstacleGrid obstacleIndex;
+    bool useIndex;
+    VoxelGrid occupancy;      // optional baked bitmap for lattice planners
     
 public:
     Map3D(int w = 50, int d = 30, int h = 20, string name = "Default City")
-        : width(w), depth(d), height(h), mapName(name) {}
+        : width(w), depth(d), height(h), mapName(name), revision(0), useIndex(true) {
+        obstacleIndex.reset(width, depth);
+    }
     
     void addObstacle(const Obstacle& obs) {
         obstacles.push_back(obs);
+        obstacleIndex.insert(obs, (int)obstacles.size() - 1);
+        if (occupancy.isBaked()) occupancy.rasterize(obs);  // only the new obstacle's region
+        revision++;
     }
     
     void loadPredefinedMap() {
         obstacles.clear();
+        revision++;
         // Buildings
         obstacles.push_back(Obstacle(Vector3D(5, 5, 0), 4, 4, 12, "Tower A"));
         obstacles.push_back(Obstacle(Vector3D(15, 8, 0), 6, 5, 8, "Office Block"));
@@ -36,21 +48,27 @@ public:
         obstacles.push_back(Obstacle(Vector3D(12, 3, 0), 1, 1, 4, "Tree"));
         obstacles.push_back(Obstacle(Vector3D(38, 20, 0), 1, 1, 3, "Tree"));
         obstacles.push_back(Obstacle(Vector3D(45, 15, 0), 1, 1, 4, "Tree"));
+        obstacleIndex.build(obstacles, width, depth);
+        if (occupancy.isBaked()) occupancy.bake(obstacles);
     }
     
     bool isBlocked(const Vector3D& point, double margin = 0.5) const {
-        if (point.getX() < 0 || point.getX() >= width ||
-            point.getY() < 0 || point.getY() >= depth ||
-            point.getZ() < 0 || point.getZ() >= height) {
+        if (isOutOfBounds(point)) {
             return true;
         }
+        if (useIndex && margin <= obstacleIndex.getMargin()) {
+            for (int idx : obstacleIndex.candidates(point)) {
+                if (obstacles[idx].containsPoint(point, margin)) return true;
+            }
+            return false;
+        }
         for (const auto& obs : obstacles) {
             if (obs.containsPoint(point, margin)) return true;
         }
         return false;
     }
     
-    // Check if line segment is clear
+    // Check if line segment is clear (sampled every 'step'; can miss thin obstacles)
     bool isPathClear(const Vector3D& from, const Vector3D& to, double step = 0.5) const {
         Vector3D dir = to - from;
         double dist = dir.magnitude();
@@ -64,11 +82,49 @@ public:
         return true;
     }
     
+    // Exact clearance: the whole segment stays inside the map and misses every
+    // obstacle inflated by margin. Walks only the index buckets the segment crosses.
+    bool isSegmentClear(const Vector3D& from, const Vector3D& to, double margin = 0.5) const {
+        // the map box is convex, so both endpoints inside means the segment is inside
+        if (isOutOfBounds(from) || isOutOfBounds(to)) return false;
+        if (useIndex && margin <= obstacleIndex.getMargin()) {
+            return obstacleIndex.walkSegment(from, to, [&](const vector<int>& bucket) {
+                for (int idx : bucket) {
+                    if (obstacles[idx].intersectsSegment(from, to, margin)) return false;
+                }
+                return true;
+            });
+        }
+        for (const auto& obs : obstacles) {
+            if (obs.intersectsSegment(from, to, margin)) return false;
+        }
+        return true;
+    }
+    
+    bool isOutOfBounds(const Vector3D& point) const {
+        return point.getX() < 0 || point.getX() >= width ||
+               point.getY() < 0 || point.getY() >= depth ||
+               point.getZ() < 0 || point.getZ() >= height;
+    }
+    
+    // toggle the bucket grid (linear scan when off) - used for benchmarking
+    void setSpatialIndexEnabled(bool enabled) { useIndex = enabled; }
+    const ObstacleGrid& getObstacleIndex() const { return obstacleIndex; }
+    
+    // rasterize obstacles (inflated by margin) into a bitmap on the lattice through 'anchor'
+    void bakeOccupancy(double resolution = 1.0, double margin = 0.5, const Vector3D& anchor = Vector3D()) {
+        occupancy.reset(width, depth, height, resolution, margin, anchor);
+        occupancy.bake(obstacles);
+    }
+    void clearOccupancy() { occupancy = VoxelGrid(); }
+    const VoxelGrid& getOccupancy() const { return occupancy; }
+    
     const vector<Obstacle>& getObstacles() const { return obstacles; }
     int getWidth() const { return width; }
     int getDepth() const { return depth; }
     int getHeight() const { return height; }
     string getName() const { return mapName; }
+    unsigned long getRevision() const { return revision; }
     
     // Get safe altitude above all obstacles
     double getSafeAltitude() const {
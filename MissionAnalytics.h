@@ -0,0 +1,324 @@
+// MissionAnalytics.h - Parallel group-by aggregation over the columnar mission log
+#ifndef MISSIONANALYTICS_H
+#define MISSIONANALYTICS_H
+
+#include "MissionLog.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <cstring>
+#include <cfloat>
+#include <ctime>
+using namespace std;
+
+// Mergeable quantile sketch. Positive values are counted in log-linear
+// buckets taken straight from the double's bits (exponent plus the top
+// kMantissaBits of the mantissa), so a bucket spans 1/64 of an octave and
+// every estimate is within 2^-7 (0.8%) of a true sample. No log() per value,
+// and two sketches merge by adding counts. Zero and negative values share one
+// bucket. Buckets are kept dense over the observed range only.
+class QuantileSketch {
+private:
+    static const int kMantissaBits = 6;
+    static const int kShift = 52 - kMantissaBits;
+
+    vector<uint32_t> counts;    // counts[i] is bucket first + i
+    long first;
+    long nonPositive;
+    long total;
+
+    static long bucketOf(double x) {
+        uint64_t bits;
+        memcpy(&bits, &x, sizeof(bits));
+        return (long)(bits >> kShift);
+    }
+
+    // midpoint of a bucket
+    static double valueOf(long bucket) {
+        uint64_t bits = ((uint64_t)bucket << kShift) | ((uint64_t)1 << (kShift - 1));
+        double x;
+        memcpy(&x, &bits, sizeof(x));
+        return x;
+    }
+
+    // make [lo, hi] addressable
+    void cover(long lo, long hi) {
+        if (counts.empty()) {
+            first = lo;
+            counts.assign((size_t)(hi - lo + 1), 0);
+            return;
+        }
+        long last = first + (long)counts.size() - 1;
+        if (lo < first) {
+            counts.insert(counts.begin(), (size_t)(first - lo), 0);
+            first = lo;
+        }
+        if (hi > last) counts.resize(counts.size() + (size_t)(hi - last), 0);
+    }
+
+public:
+    QuantileSketch() : first(0), nonPositive(0), total(0) {}
+
+    void add(double x) {
+        total++;
+        if (!(x > 0)) {
+            nonPositive++;
+            return;
+        }
+        long b = bucketOf(x);
+        if (counts.empty() || b < first || b >= first + (long)counts.size()) cover(b, b);
+        counts[(size_t)(b - first)]++;
+    }
+
+    void merge(const QuantileSketch& other) {
+        total += other.total;
+        nonPositive += other.nonPositive;
+        if (other.counts.empty()) return;
+        cover(other.first, other.first + (long)other.counts.size() - 1);
+        for (size_t i = 0; i < other.counts.size(); i++) {
+            counts[(size_t)(other.first - first) + i] += other.counts[i];
+        }
+    }
+
+    // value at rank q * (count - 1); 0 for the non-positive bucket
+    double quantile(double q) const {
+        if (total == 0) return 0;
+        long rank = (long)(q * (total - 1) + 0.5);
+        if (rank < nonPositive) return 0;
+        rank -= nonPositive;
+        for (size_t i = 0; i < counts.size(); i++) {
+            if (rank < (long)counts[i]) return valueOf(first + (long)i);
+            rank -= counts[i];
+        }
+        return valueOf(first + (long)counts.size() - 1);
+    }
+
+    long count() const { return total; }
+    size_t memoryBytes() const { return sizeof(*this) + counts.capacity() * sizeof(uint32_t); }
+};
+
+// count / sum / min / max plus a sketch for quantiles
+struct MetricSummary {
+    long count;
+    double sum, minValue, maxValue;
+    QuantileSketch sketch;
+
+    MetricSummary() : count(0), sum(0), minValue(DBL_MAX), maxValue(-DBL_MAX) {}
+
+    void add(double x) {
+        count++;
+        sum += x;
+        minValue = min(minValue, x);
+        maxValue = max(maxValue, x);
+        sketch.add(x);
+    }
+
+    void merge(const MetricSummary& o) {
+        count += o.count;
+        sum += o.sum;
+        minValue = min(minValue, o.minValue);
+        maxValue = max(maxValue, o.maxValue);
+        sketch.merge(o.sketch);
+    }
+
+    double mean() const { return count > 0 ? sum / count : 0; }
+    double getMin() const { return count > 0 ? minValue : 0; }
+    double getMax() const { return count > 0 ? maxValue : 0; }
+
+    // sketch estimate, clamped to the exact extremes
+    double quantile(double q) const {
+        if (count == 0) return 0;
+        return min(maxValue, max(minValue, sketch.quantile(q)));
+    }
+};
+
+struct GroupStats {
+    long missions;
+    long completed;
+    MetricSummary distance;
+    MetricSummary battery;
+    MetricSummary duration;
+    MetricSummary efficiency;   // battery per distance unit, missions with distance > 0
+
+    GroupStats() : missions(0), completed(0) {}
+
+    void add(double dist, double batt, double dur, bool done) {
+        missions++;
+        if (done) completed++;
+        distance.add(dist);
+        battery.add(batt);
+        duration.add(dur);
+        if (dist > 0) efficiency.add(batt / dist);
+    }
+
+    void merge(const GroupStats& o) {
+        missions += o.missions;
+        completed += o.completed;
+        distance.merge(o.distance);
+        battery.merge(o.battery);
+        duration.merge(o.duration);
+        efficiency.merge(o.efficiency);
+    }
+};
+
+struct GroupResult {
+    string key;
+    GroupStats stats;
+};
+
+// route key: start and end position as stored in the log
+struct RouteKey {
+    float coords[6];
+
+    bool operator==(const RouteKey& o) const { return memcmp(coords, o.coords, sizeof(coords)) == 0; }
+};
+
+struct RouteKeyHash {
+    size_t operator()(const RouteKey& k) const {
+        uint32_t words[6];
+        memcpy(words, k.coords, sizeof(words));
+        uint64_t h = 1469598103934665603ULL;
+        for (uint32_t w : words) h = (h ^ w) * 1099511628211ULL;
+        return (size_t)h;
+    }
+};
+
+// Splits the log into fixed-size row chunks and hands them to a thread pool.
+// Each worker folds its chunks into its own partial table (no locking, no
+// per-sample storage), and the partials are merged at the end. Sums may
+// differ from a serial pass in the last bits because chunks land on workers
+// in a different order each run.
+class MissionAnalytics {
+private:
+    ThreadPool pool;
+    size_t chunkRows;
+    size_t lastGroups;
+
+    // fold every row into per-worker maps keyed by keyOf(row), then merge
+    template <typename Key, typename Hash, typename KeyOf>
+    unordered_map<Key, GroupStats, Hash> aggregate(const ColumnarLogReader& log, KeyOf keyOf) {
+        vector<unordered_map<Key, GroupStats, Hash>> partials(pool.size());
+        long completedId = log.getStatuses().find("Completed");
+        const double* dist = log.distances();
+        const double* batt = log.batteryUsed();
+        const double* dur = log.durations();
+        const uint8_t* status = log.statusIds();
+        size_t rows = log.size();
+        size_t chunks = (rows + chunkRows - 1) / chunkRows;
+
+        pool.parallelFor(chunks, [&](size_t c, int worker) {
+            auto& table = partials[worker];
+            size_t end = min(rows, (c + 1) * chunkRows);
+            // consecutive rows often share a key; skip the hash lookup for them
+            Key lastKey = Key();
+            GroupStats* last = nullptr;
+            for (size_t i = c * chunkRows; i < end; i++) {
+                Key k = keyOf(i);
+                if (!last || !(k == lastKey)) {
+                    last = &table[k];
+                    lastKey = k;
+                }
+                last->add(dist[i], batt[i], dur[i], status[i] == completedId);
+            }
+        });
+
+        for (size_t w = 1; w < partials.size(); w++) {
+            for (const auto& entry : partials[w]) partials[0][entry.first].merge(entry.second);
+            partials[w].clear();
+        }
+        return move(partials[0]);
+    }
+
+public:
+    explicit MissionAnalytics(int threads = (int)thread::hardware_concurrency(), size_t rowsPerChunk = 16384)
+        : pool(threads), chunkRows(max((size_t)1, rowsPerChunk)), lastGroups(0) {}
+
+    // one group per drone, ordered by drone id
+    vector<GroupResult> byDrone(const ColumnarLogReader& log) {
+        const uint32_t* ids = log.droneIds();
+        auto table = aggregate<uint32_t, hash<uint32_t>>(log, [&](size_t i) { return ids[i]; });
+        vector<GroupResult> results;
+        for (auto& entry : table) {
+            GroupResult r;
+            r.key = log.getDrones().name(entry.first);
+            r.stats = move(entry.second);
+            results.push_back(move(r));
+        }
+        sort(results.begin(), results.end(),
+             [](const GroupResult& a, const GroupResult& b) { return a.key < b.key; });
+        lastGroups = results.size();
+        return results;
+    }
+
+    // One group per start -> end pair, busiest first. limit > 0 keeps only
+    // the busiest routes, which skips sorting and labelling the long tail.
+    vector<GroupResult> byRoute(const ColumnarLogReader& log, size_t limit = 0) {
+        const float* starts = log.startPositions();
+        const float* ends = log.endPositions();
+        auto table = aggregate<RouteKey, RouteKeyHash>(log, [&](size_t i) {
+            RouteKey k;
+            memcpy(k.coords, starts + 3 * i, 3 * sizeof(float));
+            memcpy(k.coords + 3, ends + 3 * i, 3 * sizeof(float));
+            return k;
+        });
+        typedef pair<const RouteKey, GroupStats>* Entry;
+        vector<Entry> order;
+        order.reserve(table.size());
+        for (auto& entry : table) order.push_back(&entry);
+        size_t keep = limit > 0 ? min(limit, order.size()) : order.size();
+        // ties broken by coordinates so the order does not depend on the hash table
+        partial_sort(order.begin(), order.begin() + keep, order.end(), [](Entry a, Entry b) {
+            if (a->second.missions != b->second.missions) return a->second.missions > b->second.missions;
+            return lexicographical_compare(a->first.coords, a->first.coords + 6, b->first.coords, b->first.coords + 6);
+        });
+        vector<GroupResult> results(keep);
+        for (size_t i = 0; i < keep; i++) {
+            results[i].key = formatPosition(order[i]->first.coords) + " -> " + formatPosition(order[i]->first.coords + 3);
+            results[i].stats = move(order[i]->second);
+        }
+        lastGroups = order.size();
+        return results;
+    }
+
+    // Fixed-width local time buckets (86400 = calendar days), oldest first.
+    // The UTC offset is taken once from the first row, so buckets can be an
+    // hour off across a DST change.
+    vector<GroupResult> byTime(const ColumnarLogReader& log, int64_t bucketSeconds = 86400) {
+        vector<GroupResult> results;
+        lastGroups = 0;
+        if (log.size() == 0 || bucketSeconds <= 0) return results;
+        const int64_t* times = log.timestamps();
+        time_t t0 = (time_t)times[0];
+        tm utc = *gmtime(&t0);
+        utc.tm_isdst = -1;
+        int64_t offset = (int64_t)t0 - (int64_t)mktime(&utc);
+
+        auto bucketOf = [&](size_t i) {
+            int64_t local = times[i] + offset;
+            return (local >= 0 ? local : local - bucketSeconds + 1) / bucketSeconds;
+        };
+        auto table = aggregate<int64_t, hash<int64_t>>(log, bucketOf);
+        vector<pair<int64_t, GroupStats*>> order;
+        for (auto& entry : table) order.push_back(make_pair(entry.first, &entry.second));
+        sort(order.begin(), order.end(),
+             [](const pair<int64_t, GroupStats*>& a, const pair<int64_t, GroupStats*>& b) { return a.first < b.first; });
+        for (auto& o : order) {
+            GroupResult r;
+            string stamp = formatTimestamp((time_t)(o.first * bucketSeconds - offset));
+            r.key = bucketSeconds % 86400 == 0 ? stamp.substr(0, 10) : stamp;
+            r.stats = move(*o.second);
+            results.push_back(move(r));
+        }
+        lastGroups = results.size();
+        return results;
+    }
+
+    // groups found by the last query, including any cut by a limit
+    size_t getGroupCount() const { return lastGroups; }
+    int getThreadCount() const { return pool.size(); }
+};
+
+#endif
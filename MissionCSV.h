@@ -0,0 +1,346 @@
+// MissionCSV.h - Allocation-free parsing of mission log CSV rows
+#ifndef MISSIONCSV_H
+#define MISSIONCSV_H
+
+#include <string>
+#include <vector>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+using namespace std;
+
+// Non-owning [begin, end) slice of a line (C++14 has no string_view)
+struct TextRange {
+    const char* begin;
+    const char* end;
+
+    TextRange(const char* b = nullptr, const char* e = nullptr) : begin(b), end(e) {}
+    size_t size() const { return (size_t)(end - begin); }
+    bool empty() const { return begin == end; }
+    string str() const { return string(begin, end); }
+};
+
+// Local "Y-M-D h:m:s" to epoch seconds.
+// mktime is slow (time zone lookup), and consecutive log rows share the hour,
+// so the start of the last hour seen is cached per thread.
+inline time_t epochFromCivil(int year, int month, int day, int hour, int minute, int second) {
+    static thread_local long cachedHourKey = -1;
+    static thread_local time_t cachedHourStart = 0;
+    long hourKey = (((long)year * 13 + month) * 32 + day) * 24 + hour;
+    if (hourKey != cachedHourKey) {
+        tm t = tm();
+        t.tm_year = year - 1900;
+        t.tm_mon = month - 1;
+        t.tm_mday = day;
+        t.tm_hour = hour;
+        t.tm_isdst = -1;
+        cachedHourStart = mktime(&t);
+        cachedHourKey = hourKey;
+    }
+    return cachedHourStart + minute * 60 + second;
+}
+
+inline void skipSpaces(const char*& p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+}
+
+// unsigned decimal integer of at most 9 digits
+inline bool parseDigits(const char*& p, const char* end, int& out) {
+    const char* start = p;
+    int value = 0;
+    while (p < end && *p >= '0' && *p <= '9' && p - start < 9) {
+        value = value * 10 + (*p - '0');
+        p++;
+    }
+    out = value;
+    return p > start;
+}
+
+// "YYYY-MM-DD HH:MM:SS" (formatTimestamp) spanning the whole range
+inline bool parseTimestampRange(const char* p, const char* end, time_t& out) {
+    int v[6];
+    const char separators[6] = {'-', '-', ' ', ':', ':', 0};
+    for (int i = 0; i < 6; i++) {
+        if (!parseDigits(p, end, v[i])) return false;
+        if (separators[i]) {
+            if (p == end || *p != separators[i]) return false;
+            p++;
+        }
+    }
+    if (p != end || v[1] < 1 || v[1] > 12 || v[2] < 1 || v[2] > 31 || v[3] > 23 || v[4] > 59 || v[5] > 60) {
+        return false;
+    }
+    out = epochFromCivil(v[0], v[1], v[2], v[3], v[4], v[5]);
+    return true;
+}
+
+// Decimal number ("-12.50", "3e2") starting at p; advances p past it.
+// Up to 15 significant digits and small exponents the value is an exactly
+// representable integer scaled by an exact power of ten, so one multiply or
+// divide gives the correctly rounded result. Anything longer goes to strtod
+// on a stack copy.
+inline bool parseDecimal(const char*& p, const char* end, double& out) {
+    static const double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                    1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char* start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+
+    uint64_t mantissa = 0;
+    int digits = 0, scale = 0;
+    bool any = false;
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            if (mantissa) digits++;
+        } else {
+            scale++;
+        }
+        any = true;
+        p++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                if (mantissa) digits++;
+                scale--;
+            }
+            any = true;
+            p++;
+        }
+    }
+    if (!any) {
+        p = start;
+        return false;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* mark = p++;
+        bool expNegative = false;
+        if (p < end && (*p == '-' || *p == '+')) expNegative = *p++ == '-';
+        int exponent;
+        if (!parseDigits(p, end, exponent)) {
+            p = mark;   // not an exponent after all; the caller sees the 'e'
+        } else {
+            scale += expNegative ? -exponent : exponent;
+        }
+    }
+
+    if (digits <= 15 && scale >= -22 && scale <= 22) {
+        double value = (double)mantissa;
+        value = scale < 0 ? value / kPow10[-scale] : value * kPow10[scale];
+        out = negative ? -value : value;
+        return true;
+    }
+    char buffer[64];
+    size_t length = (size_t)(p - start);
+    if (length >= sizeof(buffer)) {
+        p = start;
+        return false;
+    }
+    memcpy(buffer, start, length);
+    buffer[length] = '\0';
+    out = strtod(buffer, nullptr);
+    return true;
+}
+
+enum CSVError {
+    CSV_OK,
+    CSV_EMPTY_FIELD,
+    CSV_MISSING_FIELD,
+    CSV_EXTRA_FIELD,
+    CSV_BAD_NUMBER,
+    CSV_BAD_POSITION,
+    CSV_BAD_TIMESTAMP
+};
+
+inline const char* csvErrorName(CSVError e) {
+    switch (e) {
+    case CSV_OK: return "ok";
+    case CSV_EMPTY_FIELD: return "empty field";
+    case CSV_MISSING_FIELD: return "missing field";
+    case CSV_EXTRA_FIELD: return "extra field";
+    case CSV_BAD_NUMBER: return "bad number";
+    case CSV_BAD_POSITION: return "bad position";
+    case CSV_BAD_TIMESTAMP: return "bad timestamp";
+    }
+    return "?";
+}
+
+// One parsed toCSV row. Text fields point into the line, so a view is only
+// valid while the line's buffer is.
+struct MissionRecordView {
+    TextRange drone, startPos, endPos, status, timestamp;
+    float start[3], end[3];
+    double distance, batteryUsed, duration;
+    time_t epoch;
+};
+
+// "(x,y,z)" at p, advancing past the ')'
+inline bool parsePositionAt(const char*& p, const char* end, float xyz[3]) {
+    skipSpaces(p, end);
+    if (p == end || *p != '(') return false;
+    p++;
+    for (int i = 0; i < 3; i++) {
+        double v;
+        skipSpaces(p, end);
+        if (!parseDecimal(p, end, v)) return false;
+        xyz[i] = (float)v;
+        skipSpaces(p, end);
+        if (p == end || *p != (i < 2 ? ',' : ')')) return false;
+        p++;
+    }
+    return true;
+}
+
+// Parse "drone,(x,y,z),(x,y,z),distance,battery,duration,status,timestamp"
+// in one pass without allocating. field is set to the 0-based field that
+// failed. A trailing '\r' is ignored.
+inline CSVError parseMissionLine(const char* p, const char* end, MissionRecordView& out, int& field) {
+    if (end > p && end[-1] == '\r') end--;
+    const char* comma;
+
+    field = 0;
+    comma = (const char*)memchr(p, ',', (size_t)(end - p));
+    if (!comma) return CSV_MISSING_FIELD;
+    out.drone = TextRange(p, comma);
+    if (out.drone.empty()) return CSV_EMPTY_FIELD;
+    p = comma + 1;
+
+    TextRange* positionText[2] = {&out.startPos, &out.endPos};
+    float* positions[2] = {out.start, out.end};
+    for (int i = 0; i < 2; i++) {
+        field = 1 + i;
+        const char* from = p;
+        if (!parsePositionAt(p, end, positions[i])) return p == end ? CSV_MISSING_FIELD : CSV_BAD_POSITION;
+        *positionText[i] = TextRange(from, p);
+        skipSpaces(p, end);
+        if (p == end) return CSV_MISSING_FIELD;
+        if (*p++ != ',') return CSV_BAD_POSITION;
+    }
+
+    double* numbers[3] = {&out.distance, &out.batteryUsed, &out.duration};
+    for (int i = 0; i < 3; i++) {
+        field = 3 + i;
+        skipSpaces(p, end);
+        if (p == end) return CSV_MISSING_FIELD;
+        if (!parseDecimal(p, end, *numbers[i])) return CSV_BAD_NUMBER;
+        skipSpaces(p, end);
+        if (p == end) return CSV_MISSING_FIELD;
+        if (*p++ != ',') return CSV_BAD_NUMBER;
+    }
+
+    field = 6;
+    comma = (const char*)memchr(p, ',', (size_t)(end - p));
+    if (!comma) return CSV_MISSING_FIELD;
+    out.status = TextRange(p, comma);
+    if (out.status.empty()) return CSV_EMPTY_FIELD;
+    p = comma + 1;
+
+    field = 7;
+    if (memchr(p, ',', (size_t)(end - p))) return CSV_EXTRA_FIELD;
+    out.timestamp = TextRange(p, end);
+    if (out.timestamp.empty()) return CSV_EMPTY_FIELD;
+    if (!parseTimestampRange(p, end, out.epoch)) return CSV_BAD_TIMESTAMP;
+    return CSV_OK;
+}
+
+struct CSVIssue {
+    size_t line;        // 1-based
+    int field;          // 0-based
+    CSVError error;
+};
+
+struct CSVScanReport {
+    size_t lines;       // non-blank lines seen
+    size_t rows;        // rows parsed
+    size_t malformed;   // rows skipped
+    size_t bytes;
+    vector<CSVIssue> issues;    // the first kMaxIssues malformed rows
+
+    static const size_t kMaxIssues = 8;
+
+    CSVScanReport() : lines(0), rows(0), malformed(0), bytes(0) {}
+};
+
+// Streams a mission CSV in fixed-size chunks, parsing each complete line in
+// place, so memory stays at one chunk however large the file is. A line cut
+// by the chunk boundary is moved to the front and completed by the next read.
+// Malformed rows are counted and skipped, never passed on half-filled.
+class MissionCSVScanner {
+private:
+    FILE* file;
+    vector<char> buffer;
+    CSVScanReport report;
+
+    template <typename Visitor>
+    void scanLine(const char* begin, const char* end, size_t lineNo, Visitor& visit) {
+        if (begin == end || (end - begin == 1 && *begin == '\r')) return;
+        report.lines++;
+        MissionRecordView view;
+        int field;
+        CSVError error = parseMissionLine(begin, end, view, field);
+        if (error == CSV_OK) {
+            report.rows++;
+            visit(view);
+            return;
+        }
+        report.malformed++;
+        if (report.issues.size() < CSVScanReport::kMaxIssues) {
+            CSVIssue issue = {lineNo, field, error};
+            report.issues.push_back(issue);
+        }
+    }
+
+public:
+    explicit MissionCSVScanner(size_t chunkBytes = 1 << 20) : file(nullptr), buffer(chunkBytes) {}
+    ~MissionCSVScanner() { close(); }
+
+    MissionCSVScanner(const MissionCSVScanner&) = delete;
+    MissionCSVScanner& operator=(const MissionCSVScanner&) = delete;
+
+    bool open(const string& path) {
+        close();
+        report = CSVScanReport();
+        file = fopen(path.c_str(), "rb");
+        return file != nullptr;
+    }
+
+    void close() {
+        if (file) fclose(file);
+        file = nullptr;
+    }
+
+    // calls visit(const MissionRecordView&) for every well-formed row; returns the row count
+    template <typename Visitor>
+    size_t scan(Visitor visit) {
+        if (!file) return 0;
+        size_t carry = 0, lineNo = 0;
+        while (true) {
+            if (carry == buffer.size()) buffer.resize(buffer.size() * 2);   // a line longer than a chunk
+            size_t got = fread(buffer.data() + carry, 1, buffer.size() - carry, file);
+            report.bytes += got;
+            const char* p = buffer.data();
+            const char* end = p + carry + got;
+            if (got == 0) {
+                if (p < end) scanLine(p, end, ++lineNo, visit);
+                break;
+            }
+            while (const char* newline = (const char*)memchr(p, '\n', (size_t)(end - p))) {
+                scanLine(p, newline, ++lineNo, visit);
+                p = newline + 1;
+            }
+            carry = (size_t)(end - p);
+            memmove(buffer.data(), p, carry);
+        }
+        return report.rows;
+    }
+
+    const CSVScanReport& getReport() const { return report; }
+};
+
+#endif
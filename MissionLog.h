@@ -0,0 +1,547 @@
+// MissionLog.h - Mission records and the append-only binary columnar mission log
+#ifndef MISSIONLOG_H
+#define MISSIONLOG_H
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <ctime>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <algorithm>
+#include "MissionCSV.h"
+
+using namespace std;
+
+// "YYYY-MM-DD HH:MM:SS" in local time
+inline string formatTimestamp(time_t t) {
+    tm* ltm = localtime(&t);
+    stringstream ss;
+    ss << 1900 + ltm->tm_year << "-"
+       << setfill('0') << setw(2) << 1 + ltm->tm_mon << "-"
+       << setw(2) << ltm->tm_mday << " "
+       << setw(2) << ltm->tm_hour << ":"
+       << setw(2) << ltm->tm_min << ":"
+       << setw(2) << ltm->tm_sec;
+    return ss.str();
+}
+
+// inverse of formatTimestamp; 0 if the text is not a timestamp
+inline time_t parseTimestamp(const string& text) {
+    time_t t;
+    return parseTimestampRange(text.data(), text.data() + text.size(), t) ? t : 0;
+}
+
+// Mission result structure
+struct MissionResult {
+    string droneId;
+    string startPos;
+    string endPos;
+    double distance;
+    double batteryUsed;
+    double duration;
+    string status;
+    string timestamp;
+
+    MissionResult() : distance(0), batteryUsed(0), duration(0) {}
+
+    string toCSV() const {
+        stringstream ss;
+        ss << droneId << "," << startPos << "," << endPos << ","
+           << fixed << setprecision(2) << distance << ","
+           << batteryUsed << "," << duration << "," << status << "," << timestamp;
+        return ss.str();
+    }
+
+    // false (and result untouched) if the line is not a well-formed toCSV row
+    static bool parseCSV(const string& line, MissionResult& result) {
+        MissionRecordView view;
+        int field;
+        if (parseMissionLine(line.data(), line.data() + line.size(), view, field) != CSV_OK) return false;
+        result.droneId.assign(view.drone.begin, view.drone.end);
+        result.startPos.assign(view.startPos.begin, view.startPos.end);
+        result.endPos.assign(view.endPos.begin, view.endPos.end);
+        result.distance = view.distance;
+        result.batteryUsed = view.batteryUsed;
+        result.duration = view.duration;
+        result.status.assign(view.status.begin, view.status.end);
+        result.timestamp.assign(view.timestamp.begin, view.timestamp.end);
+        return true;
+    }
+
+    // default-initialized result for a malformed line; use parseCSV to tell
+    static MissionResult fromCSV(const string& line) {
+        MissionResult result;
+        parseCSV(line, result);
+        return result;
+    }
+};
+
+// "(x,y,z)" <-> three floats
+inline void parsePosition(const string& text, float xyz[3]) {
+    double x = 0, y = 0, z = 0;
+    sscanf(text.c_str(), " (%lf ,%lf ,%lf", &x, &y, &z);
+    xyz[0] = (float)x;
+    xyz[1] = (float)y;
+    xyz[2] = (float)z;
+}
+
+inline string formatPosition(const float xyz[3]) {
+    return "(" + to_string((int)xyz[0]) + "," + to_string((int)xyz[1]) + "," + to_string((int)xyz[2]) + ")";
+}
+
+// Read-only memory mapping of a whole file. Empty or missing files map to
+// size 0 with a null data pointer.
+class MappedFile {
+private:
+    const char* base;
+    size_t length;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+
+    void release() {
+#ifdef _WIN32
+        if (base) UnmapViewOfFile(base);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (base) munmap((void*)base, length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+
+public:
+#ifdef _WIN32
+    MappedFile() : base(nullptr), length(0), file(INVALID_HANDLE_VALUE), mapping(NULL) {}
+#else
+    MappedFile() : base(nullptr), length(0) {}
+#endif
+    ~MappedFile() { release(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const string& path) {
+        release();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) return false;
+        length = (size_t)size.QuadPart;
+        if (length == 0) return true;
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mapping) return false;
+        base = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!base) {
+            length = 0;
+            return false;
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            return false;
+        }
+        length = (size_t)st.st_size;
+        if (length > 0) {
+            void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                length = 0;
+                close(fd);
+                return false;
+            }
+            base = (const char*)p;
+        }
+        close(fd);
+#endif
+        return true;
+    }
+
+    const char* data() const { return base; }
+    size_t size() const { return length; }
+};
+
+// Column files of a log at <base><suffix>. Every file starts with a 16 byte
+// header (magic, version, element width) followed by fixed-width values, so
+// row i of a column lives at 16 + i * width and needs no parsing.
+enum MissionColumn {
+    COL_DRONE,      // uint32 id into the drone dictionary
+    COL_START,      // float32 x, y, z
+    COL_END,        // float32 x, y, z
+    COL_DISTANCE,   // float64
+    COL_BATTERY,    // float64
+    COL_DURATION,   // float64
+    COL_STATUS,     // uint8 id into the status dictionary
+    COL_TIME,       // int64 epoch seconds
+    COL_COUNT
+};
+
+struct ColumnSpec {
+    const char* suffix;
+    uint32_t width;
+};
+
+constexpr ColumnSpec kMissionColumns[COL_COUNT] = {
+    {".drone.col", 4}, {".start.col", 12}, {".end.col", 12}, {".distance.col", 8},
+    {".battery.col", 8}, {".duration.col", 8}, {".status.col", 1}, {".time.col", 8}
+};
+
+constexpr uint32_t kColumnMagic = 0x4C434644;   // "DFCL"
+constexpr uint32_t kColumnVersion = 1;
+constexpr size_t kColumnHeaderBytes = 16;
+
+// interned strings (drone ids, statuses); ids are assigned in first-seen order
+class StringDictionary {
+private:
+    vector<string> names;
+    unordered_map<string, uint32_t> ids;
+
+public:
+    // returns the id; sets added when the name is new
+    uint32_t intern(const string& name, bool& added) {
+        auto it = ids.find(name);
+        added = it == ids.end();
+        if (!added) return it->second;
+        uint32_t id = (uint32_t)names.size();
+        names.push_back(name);
+        ids[name] = id;
+        return id;
+    }
+
+    // -1 if the name was never interned
+    long find(const string& name) const {
+        auto it = ids.find(name);
+        return it == ids.end() ? -1 : (long)it->second;
+    }
+
+    const string& name(uint32_t id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+    void clear() {
+        names.clear();
+        ids.clear();
+    }
+};
+
+inline bool columnLogExists(const string& base) {
+    ifstream probe(base + kMissionColumns[COL_DRONE].suffix, ios::binary);
+    return probe.good();
+}
+
+// The dictionary file holds one "D<tab>name" or "S<tab>name" line per
+// interned string, in id order.
+inline void loadDictionaries(const string& base, StringDictionary& drones, StringDictionary& statuses) {
+    drones.clear();
+    statuses.clear();
+    ifstream file(base + ".dict");
+    string line;
+    bool added;
+    while (getline(file, line)) {
+        if (line.size() < 2 || line[1] != '\t') continue;
+        if (line[0] == 'D') drones.intern(line.substr(2), added);
+        else if (line[0] == 'S') statuses.intern(line.substr(2), added);
+    }
+}
+
+// Appends rows to the column files. Rows are encoded into per-column
+// buffers and only reach disk on flush(), which writes every column for the
+// staged rows; on open, columns left uneven by an interrupted flush are cut
+// back to the shortest one.
+class ColumnarLogWriter {
+private:
+    string base;
+    FILE* columns[COL_COUNT];
+    FILE* dictFile;
+    vector<char> pending[COL_COUNT];
+    string pendingDict;
+    StringDictionary drones;
+    StringDictionary statuses;
+    size_t rows;            // rows on disk
+    size_t pendingRows;     // rows staged since the last flush
+    string droneScratch, statusScratch;
+
+    static size_t columnRows(const string& path, uint32_t width) {
+        ifstream f(path, ios::binary | ios::ate);
+        if (!f.is_open()) return 0;
+        size_t bytes = (size_t)f.tellg();
+        return bytes <= kColumnHeaderBytes ? 0 : (bytes - kColumnHeaderBytes) / width;
+    }
+
+    // rewrite a column keeping only its first keepRows rows
+    static void truncateColumn(const string& path, uint32_t width, size_t keepRows) {
+        size_t bytes = kColumnHeaderBytes + keepRows * width;
+        vector<char> buffer(bytes);
+        {
+            ifstream in(path, ios::binary);
+            in.read(buffer.data(), (streamsize)bytes);
+        }
+        ofstream out(path, ios::binary | ios::trunc);
+        out.write(buffer.data(), (streamsize)bytes);
+    }
+
+    // push stdio buffers to the OS, and with durable also to the disk
+    static void syncFile(FILE* f, bool durable) {
+        fflush(f);
+        if (!durable) return;
+#ifdef _WIN32
+        _commit(_fileno(f));
+#else
+        fsync(fileno(f));
+#endif
+    }
+
+    template <typename T>
+    void stage(MissionColumn c, const T* values, size_t count) {
+        const char* bytes = (const char*)values;
+        pending[c].insert(pending[c].end(), bytes, bytes + sizeof(T) * count);
+    }
+
+    void stageRow(const string& drone, const string& status, const float start[3], const float end[3],
+                  double distance, double batteryUsed, double duration, int64_t epoch) {
+        bool added;
+        uint32_t droneId = drones.intern(drone, added);
+        if (added) pendingDict += "D\t" + drone + "\n";
+        uint8_t statusId = (uint8_t)statuses.intern(status, added);
+        if (added) pendingDict += "S\t" + status + "\n";
+
+        stage(COL_DRONE, &droneId, 1);
+        stage(COL_START, start, 3);
+        stage(COL_END, end, 3);
+        stage(COL_DISTANCE, &distance, 1);
+        stage(COL_BATTERY, &batteryUsed, 1);
+        stage(COL_DURATION, &duration, 1);
+        stage(COL_STATUS, &statusId, 1);
+        stage(COL_TIME, &epoch, 1);
+        pendingRows++;
+    }
+
+public:
+    ColumnarLogWriter() : dictFile(nullptr), rows(0), pendingRows(0) {
+        for (auto& col : columns) col = nullptr;
+    }
+    ~ColumnarLogWriter() { close(); }
+
+    ColumnarLogWriter(const ColumnarLogWriter&) = delete;
+    ColumnarLogWriter& operator=(const ColumnarLogWriter&) = delete;
+
+    // creates the log if needed; truncate starts an empty log
+    bool open(const string& logBase, bool truncate = false) {
+        close();
+        base = logBase;
+        rows = 0;
+        if (!truncate) {
+            size_t minRows = 0, maxRows = 0;
+            for (int c = 0; c < COL_COUNT; c++) {
+                size_t n = columnRows(base + kMissionColumns[c].suffix, kMissionColumns[c].width);
+                minRows = c == 0 ? n : min(minRows, n);
+                maxRows = max(maxRows, n);
+            }
+            if (minRows != maxRows) {
+                for (int c = 0; c < COL_COUNT; c++) {
+                    truncateColumn(base + kMissionColumns[c].suffix, kMissionColumns[c].width, minRows);
+                }
+            }
+            rows = minRows;
+        }
+
+        bool ok = true;
+        for (int c = 0; c < COL_COUNT; c++) {
+            string path = base + kMissionColumns[c].suffix;
+            bool fresh = truncate || columnRows(path, 1) == 0;
+            columns[c] = fopen(path.c_str(), fresh ? "wb" : "ab");
+            if (!columns[c]) {
+                ok = false;
+                continue;
+            }
+            if (fresh) {
+                uint32_t header[4] = {kColumnMagic, kColumnVersion, kMissionColumns[c].width, 0};
+                fwrite(header, sizeof(header), 1, columns[c]);
+                fflush(columns[c]);
+            }
+        }
+        if (truncate) {
+            drones.clear();
+            statuses.clear();
+        } else {
+            loadDictionaries(base, drones, statuses);
+        }
+        dictFile = fopen((base + ".dict").c_str(), truncate ? "w" : "a");
+        return ok && dictFile != nullptr;
+    }
+
+    // flushes staged rows, then closes the files
+    void close() {
+        if (dictFile) flush();
+        for (auto& col : columns) {
+            if (col) fclose(col);
+            col = nullptr;
+        }
+        if (dictFile) fclose(dictFile);
+        dictFile = nullptr;
+    }
+
+    // stage one row; nothing touches the disk until flush()
+    void append(const MissionResult& m) {
+        float start[3], end[3];
+        parsePosition(m.startPos, start);
+        parsePosition(m.endPos, end);
+        stageRow(m.droneId, m.status, start, end, m.distance, m.batteryUsed, m.duration,
+                 (int64_t)parseTimestamp(m.timestamp));
+    }
+
+    // same for a row parsed straight out of a CSV buffer; the names are
+    // copied into reused scratch strings, so steady state does not allocate
+    void append(const MissionRecordView& v) {
+        droneScratch.assign(v.drone.begin, v.drone.end);
+        statusScratch.assign(v.status.begin, v.status.end);
+        stageRow(droneScratch, statusScratch, v.start, v.end, v.distance, v.batteryUsed, v.duration,
+                 (int64_t)v.epoch);
+    }
+
+    // Write staged rows. New dictionary names go first so a reader never sees
+    // an id it cannot resolve. durable also syncs the files to disk.
+    void flush(bool durable = false) {
+        if (!dictFile) return;
+        if (!pendingDict.empty()) {
+            fwrite(pendingDict.data(), 1, pendingDict.size(), dictFile);
+            pendingDict.clear();
+        }
+        syncFile(dictFile, durable);
+        for (int c = 0; c < COL_COUNT; c++) {
+            if (!columns[c]) continue;
+            if (!pending[c].empty()) {
+                fwrite(pending[c].data(), 1, pending[c].size(), columns[c]);
+                pending[c].clear();
+            }
+            syncFile(columns[c], durable);
+        }
+        rows += pendingRows;
+        pendingRows = 0;
+    }
+
+    size_t size() const { return rows + pendingRows; }
+    size_t getPendingRows() const { return pendingRows; }
+    size_t getPendingBytes() const {
+        size_t bytes = pendingDict.size();
+        for (const auto& p : pending) bytes += p.size();
+        return bytes;
+    }
+    const string& getBase() const { return base; }
+};
+
+// Maps every column and exposes them as typed arrays. The row count is that
+// of the shortest column, so a reader never sees a half-written row.
+class ColumnarLogReader {
+private:
+    MappedFile files[COL_COUNT];
+    StringDictionary drones;
+    StringDictionary statuses;
+    size_t rows;
+
+    template <typename T>
+    const T* column(MissionColumn c) const {
+        return (const T*)(files[c].data() + kColumnHeaderBytes);
+    }
+
+public:
+    ColumnarLogReader() : rows(0) {}
+    explicit ColumnarLogReader(const string& base) : rows(0) { open(base); }
+
+    bool open(const string& base) {
+        rows = 0;
+        for (int c = 0; c < COL_COUNT; c++) {
+            if (!files[c].open(base + kMissionColumns[c].suffix)) return false;
+            const uint32_t* header = (const uint32_t*)files[c].data();
+            if (files[c].size() < kColumnHeaderBytes || header[0] != kColumnMagic ||
+                header[2] != kMissionColumns[c].width) {
+                return false;
+            }
+        }
+        rows = (files[0].size() - kColumnHeaderBytes) / kMissionColumns[0].width;
+        for (int c = 1; c < COL_COUNT; c++) {
+            rows = min(rows, (files[c].size() - kColumnHeaderBytes) / kMissionColumns[c].width);
+        }
+        loadDictionaries(base, drones, statuses);
+        return true;
+    }
+
+    size_t size() const { return rows; }
+
+    // raw columns, each valid for [0, size())
+    const uint32_t* droneIds() const { return column<uint32_t>(COL_DRONE); }
+    const float* startPositions() const { return column<float>(COL_START); }   // xyz triples
+    const float* endPositions() const { return column<float>(COL_END); }
+    const double* distances() const { return column<double>(COL_DISTANCE); }
+    const double* batteryUsed() const { return column<double>(COL_BATTERY); }
+    const double* durations() const { return column<double>(COL_DURATION); }
+    const uint8_t* statusIds() const { return column<uint8_t>(COL_STATUS); }
+    const int64_t* timestamps() const { return column<int64_t>(COL_TIME); }
+
+    const StringDictionary& getDrones() const { return drones; }
+    const StringDictionary& getStatuses() const { return statuses; }
+
+    MissionResult row(size_t i) const {
+        MissionResult m;
+        m.droneId = drones.name(droneIds()[i]);
+        m.startPos = formatPosition(startPositions() + 3 * i);
+        m.endPos = formatPosition(endPositions() + 3 * i);
+        m.distance = distances()[i];
+        m.batteryUsed = batteryUsed()[i];
+        m.duration = durations()[i];
+        m.status = statuses.name(statusIds()[i]);
+        m.timestamp = formatTimestamp((time_t)timestamps()[i]);
+        return m;
+    }
+};
+
+// CSV bridge: append every well-formed row of a toCSV file to a columnar
+// log. Malformed rows are skipped and described in report (if given).
+inline size_t importMissionCSV(const string& csvPath, const string& base, bool truncate = false,
+                               CSVScanReport* report = nullptr) {
+    MissionCSVScanner scanner;
+    ColumnarLogWriter writer;
+    if (!scanner.open(csvPath) || !writer.open(base, truncate)) return 0;
+    size_t count = scanner.scan([&](const MissionRecordView& v) {
+        writer.append(v);
+        // keep the staging buffers bounded on large files
+        if (writer.getPendingRows() >= 65536) writer.flush();
+    });
+    writer.flush();
+    if (report) *report = scanner.getReport();
+    return count;
+}
+
+// CSV bridge: write a columnar log back out in the toCSV format
+inline size_t exportMissionCSV(const string& base, const string& csvPath) {
+    ColumnarLogReader reader;
+    if (!reader.open(base)) return 0;
+    ofstream out(csvPath, ios::trunc);
+    if (!out.is_open()) return 0;
+    for (size_t i = 0; i < reader.size(); i++) {
+        out << reader.row(i).toCSV() << '\n';
+    }
+    return reader.size();
+}
+
+#endif
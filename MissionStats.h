@@ -0,0 +1,188 @@
+// MissionStats.h - Running mission aggregates with a sidecar snapshot file
+#ifndef MISSIONSTATS_H
+#define MISSIONSTATS_H
+
+#include "MissionLog.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <cstdio>
+#include <unordered_map>
+using namespace std;
+
+struct DroneStats {
+    string droneId;
+    long missions;
+    double distance;
+    double battery;
+    double duration;
+    long effMissions;   // missions with distance > 0
+    double effSum;      // sum of batteryUsed / distance over those
+
+    DroneStats(const string& id = "")
+        : droneId(id), missions(0), distance(0), battery(0), duration(0), effMissions(0), effSum(0) {}
+
+    double avgEfficiency() const { return effMissions > 0 ? effSum / effMissions : 0; }
+};
+
+// Totals, per-drone figures and a status histogram, updated per mission.
+// rowCount() is the number of log rows folded in, which is how a snapshot is
+// matched against the log it was taken from.
+class MissionStats {
+private:
+    long count;
+    double totalDistance, totalBattery, totalTime;
+    vector<DroneStats> drones;                  // first-seen order
+    unordered_map<string, size_t> droneIndex;
+    vector<pair<string, long>> statuses;        // histogram, first-seen order
+    unordered_map<string, size_t> statusIndex;
+
+    // index of the drone's entry, created on first sight
+    size_t droneSlot(const string& id) {
+        auto it = droneIndex.find(id);
+        if (it != droneIndex.end()) return it->second;
+        droneIndex[id] = drones.size();
+        drones.push_back(DroneStats(id));
+        return drones.size() - 1;
+    }
+
+    size_t statusSlot(const string& status) {
+        auto it = statusIndex.find(status);
+        if (it != statusIndex.end()) return it->second;
+        statusIndex[status] = statuses.size();
+        statuses.push_back(make_pair(status, 0L));
+        return statuses.size() - 1;
+    }
+
+    void addValues(DroneStats& d, long& statusCount, double distance, double battery, double duration) {
+        count++;
+        totalDistance += distance;
+        totalBattery += battery;
+        totalTime += duration;
+        statusCount++;
+        d.missions++;
+        d.distance += distance;
+        d.battery += battery;
+        d.duration += duration;
+        if (distance > 0) {
+            d.effMissions++;
+            d.effSum += battery / distance;
+        }
+    }
+
+public:
+    MissionStats() { clear(); }
+
+    void clear() {
+        count = 0;
+        totalDistance = totalBattery = totalTime = 0;
+        drones.clear();
+        droneIndex.clear();
+        statuses.clear();
+        statusIndex.clear();
+    }
+
+    // O(1): fold one mission in
+    void add(const MissionResult& m) {
+        addValues(drones[droneSlot(m.droneId)], statuses[statusSlot(m.status)].second,
+                  m.distance, m.batteryUsed, m.duration);
+    }
+
+    // fold in log rows [from, reader.size()) straight from the columns
+    void addRows(const ColumnarLogReader& reader, size_t from) {
+        const StringDictionary& names = reader.getDrones();
+        const StringDictionary& statusNames = reader.getStatuses();
+        // log dictionary id -> our slot, resolved once per name
+        vector<long> droneOf(names.size(), -1);
+        vector<long> statusOf(statusNames.size(), -1);
+        const uint32_t* ids = reader.droneIds();
+        const uint8_t* st = reader.statusIds();
+        const double* dist = reader.distances();
+        const double* batt = reader.batteryUsed();
+        const double* dur = reader.durations();
+        for (size_t i = from; i < reader.size(); i++) {
+            long& d = droneOf[ids[i]];
+            if (d < 0) d = (long)droneSlot(names.name(ids[i]));
+            long& s = statusOf[st[i]];
+            if (s < 0) s = (long)statusSlot(statusNames.name(st[i]));
+            addValues(drones[d], statuses[s].second, dist[i], batt[i], dur[i]);
+        }
+    }
+
+    // full recount from the log
+    void rebuild(const ColumnarLogReader& reader) {
+        clear();
+        addRows(reader, 0);
+    }
+
+    // Sidecar format: a version line, then one record per line. Names come
+    // last on their line because statuses contain spaces.
+    bool save(const string& path) const {
+        string tmp = path + ".tmp";
+        {
+            ofstream out(tmp, ios::trunc);
+            if (!out.is_open()) return false;
+            out << setprecision(17);
+            out << "DFPSTATS 1\n";
+            out << "totals " << count << " " << totalDistance << " " << totalBattery << " " << totalTime << "\n";
+            for (const auto& s : statuses) out << "status " << s.second << " " << s.first << "\n";
+            for (const auto& d : drones) {
+                out << "drone " << d.missions << " " << d.distance << " " << d.battery << " " << d.duration
+                    << " " << d.effMissions << " " << d.effSum << " " << d.droneId << "\n";
+            }
+            if (!out.good()) return false;
+        }
+        // replace in one step so a crash never leaves a half-written snapshot
+        remove(path.c_str());
+        return rename(tmp.c_str(), path.c_str()) == 0;
+    }
+
+    bool load(const string& path) {
+        clear();
+        ifstream in(path);
+        string line;
+        if (!getline(in, line) || line != "DFPSTATS 1") return false;
+        while (getline(in, line)) {
+            istringstream ss(line);
+            string kind;
+            ss >> kind;
+            if (kind == "totals") {
+                ss >> count >> totalDistance >> totalBattery >> totalTime;
+            } else if (kind == "status") {
+                long n = 0;
+                string name;
+                ss >> n;
+                ss.get();
+                getline(ss, name);
+                statuses[statusSlot(name)].second = n;
+            } else if (kind == "drone") {
+                DroneStats d;
+                ss >> d.missions >> d.distance >> d.battery >> d.duration >> d.effMissions >> d.effSum;
+                ss.get();
+                getline(ss, d.droneId);
+                drones[droneSlot(d.droneId)] = d;
+            }
+            if (ss.fail()) {
+                clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t rowCount() const { return (size_t)count; }
+    double getTotalDistance() const { return totalDistance; }
+    double getTotalBattery() const { return totalBattery; }
+    double getTotalTime() const { return totalTime; }
+    const vector<DroneStats>& getDrones() const { return drones; }
+    const vector<pair<string, long>>& getStatusHistogram() const { return statuses; }
+
+    long getStatusCount(const string& status) const {
+        auto it = statusIndex.find(status);
+        return it == statusIndex.end() ? 0 : statuses[it->second].second;
+    }
+};
+
+#endif
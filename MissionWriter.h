@@ -0,0 +1,205 @@
+// MissionWriter.h - Buffered mission log writer with flush policy and optional writer thread
+#ifndef MISSIONWRITER_H
+#define MISSIONWRITER_H
+
+#include "MissionLog.h"
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+using namespace std;
+
+// When staged records are written out. A limit of 0 disables that trigger.
+struct FlushPolicy {
+    size_t maxRecords;      // flush once this many records are pending
+    size_t maxBytes;        // flush once this many encoded bytes are pending
+    int maxIntervalMs;      // flush records older than this
+    bool durable;           // fsync every flush, not only explicit barriers
+
+    FlushPolicy(size_t records = 256, size_t bytes = 64 * 1024, int intervalMs = 1000, bool sync = false)
+        : maxRecords(records), maxBytes(bytes), maxIntervalMs(intervalMs), durable(sync) {}
+
+    // flush after every record (the old one-line-per-mission behaviour)
+    static FlushPolicy everyRecord() { return FlushPolicy(1, 0, 0, false); }
+};
+
+// Long-lived writer in front of a ColumnarLogWriter.
+// Inline mode encodes and flushes on the caller's thread when the policy
+// says so. Background mode only queues the record under a lock; a writer
+// thread encodes, applies the policy (including the interval, even when no
+// new records arrive) and does all disk I/O.
+// flush() is a barrier: when it returns, every record appended before the
+// call is on disk and synced.
+// Without a running writer thread (before open(), after close(), or when
+// open() failed) background mode falls back to the inline path, so a
+// barrier never waits on a thread that is not there.
+class BufferedMissionWriter {
+private:
+    ColumnarLogWriter log;
+    FlushPolicy policy;
+    bool background;
+
+    // inline mode: when the oldest staged record was appended
+    chrono::steady_clock::time_point oldestPending;
+
+    // background mode
+    thread worker;
+    mutex lock;
+    condition_variable wake;
+    condition_variable drained;
+    vector<MissionResult> queue;
+    size_t queuedBytes;
+    chrono::steady_clock::time_point queuedSince;   // when the queue last became non-empty
+    unsigned long syncRequested;    // flush() calls so far
+    unsigned long syncCompleted;    // flush() calls whose records are on disk
+    bool reopenRequested;
+    bool truncateOnReopen;
+    bool stopping;
+
+    // rough encoded size of a record before it is encoded
+    static size_t recordBytes(const MissionResult& m) {
+        size_t rowBytes = 0;
+        for (const auto& spec : kMissionColumns) rowBytes += spec.width;
+        return rowBytes + m.droneId.size() + m.status.size();
+    }
+
+    bool policyDue(size_t records, size_t bytes, chrono::steady_clock::time_point oldest) const {
+        if (records == 0) return false;
+        if (policy.maxRecords > 0 && records >= policy.maxRecords) return true;
+        if (policy.maxBytes > 0 && bytes >= policy.maxBytes) return true;
+        if (policy.maxIntervalMs > 0 &&
+            chrono::steady_clock::now() - oldest >= chrono::milliseconds(policy.maxIntervalMs)) {
+            return true;
+        }
+        return false;
+    }
+
+    void workerLoop() {
+        vector<MissionResult> batch;
+        unique_lock<mutex> guard(lock);
+        while (true) {
+            bool syncDue = syncRequested != syncCompleted;
+            if (!syncDue && !stopping && !reopenRequested &&
+                !policyDue(queue.size(), queuedBytes, queuedSince)) {
+                if (!queue.empty() && policy.maxIntervalMs > 0) {
+                    wake.wait_until(guard, queuedSince + chrono::milliseconds(policy.maxIntervalMs));
+                } else {
+                    wake.wait(guard);
+                }
+                continue;
+            }
+
+            batch.swap(queue);
+            queuedBytes = 0;
+            unsigned long syncTarget = syncRequested;
+            bool reopen = reopenRequested, truncate = truncateOnReopen, exiting = stopping;
+            guard.unlock();
+
+            // encode and write without holding the lock so producers never wait on I/O
+            for (const auto& m : batch) log.append(m);
+            batch.clear();
+            log.flush(syncDue || reopen || exiting || policy.durable);
+            if (reopen) log.open(log.getBase(), truncate);
+
+            guard.lock();
+            syncCompleted = syncTarget;
+            if (reopen) reopenRequested = false;
+            drained.notify_all();
+            if (exiting) return;
+        }
+    }
+
+public:
+    BufferedMissionWriter(const FlushPolicy& flushPolicy = FlushPolicy(), bool useThread = false)
+        : policy(flushPolicy), background(useThread), queuedBytes(0), syncRequested(0), syncCompleted(0),
+          reopenRequested(false), truncateOnReopen(false), stopping(false) {}
+
+    ~BufferedMissionWriter() { close(); }
+
+    BufferedMissionWriter(const BufferedMissionWriter&) = delete;
+    BufferedMissionWriter& operator=(const BufferedMissionWriter&) = delete;
+
+    bool open(const string& base, bool truncate = false) {
+        close();
+        bool ok = log.open(base, truncate);
+        oldestPending = chrono::steady_clock::now();
+        if (background && ok) {
+            stopping = false;
+            worker = thread(&BufferedMissionWriter::workerLoop, this);
+        }
+        return ok;
+    }
+
+    // writes everything still pending and stops the writer thread
+    void close() {
+        if (worker.joinable()) {
+            {
+                lock_guard<mutex> guard(lock);
+                stopping = true;
+            }
+            wake.notify_all();
+            worker.join();
+        }
+        log.close();
+    }
+
+    void append(const MissionResult& m) {
+        if (!background || !worker.joinable()) {
+            if (log.getPendingRows() == 0) oldestPending = chrono::steady_clock::now();
+            log.append(m);
+            if (policyDue(log.getPendingRows(), log.getPendingBytes(), oldestPending)) {
+                log.flush(policy.durable);
+            }
+            return;
+        }
+        bool notify;
+        {
+            lock_guard<mutex> guard(lock);
+            if (queue.empty()) queuedSince = chrono::steady_clock::now();
+            queue.push_back(m);
+            queuedBytes += recordBytes(m);
+            notify = queue.size() == 1 ||
+                     (policy.maxRecords > 0 && queue.size() >= policy.maxRecords) ||
+                     (policy.maxBytes > 0 && queuedBytes >= policy.maxBytes);
+        }
+        if (notify) wake.notify_one();
+    }
+
+    // durability barrier: returns once every earlier append is on disk and synced
+    void flush() {
+        if (!background || !worker.joinable()) {
+            log.flush(true);
+            return;
+        }
+        unique_lock<mutex> guard(lock);
+        unsigned long ticket = ++syncRequested;
+        wake.notify_one();
+        drained.wait(guard, [&] { return syncCompleted >= ticket; });
+    }
+
+    // start over on the same files (truncate clears the log)
+    void reopen(bool truncate) {
+        if (!background || !worker.joinable()) {
+            log.open(log.getBase(), truncate);
+            return;
+        }
+        unique_lock<mutex> guard(lock);
+        reopenRequested = true;
+        truncateOnReopen = truncate;
+        wake.notify_one();
+        drained.wait(guard, [&] { return !reopenRequested; });
+    }
+
+    void setPolicy(const FlushPolicy& flushPolicy) {
+        lock_guard<mutex> guard(lock);
+        policy = flushPolicy;
+    }
+
+    const FlushPolicy& getPolicy() const { return policy; }
+    bool isBackground() const { return background; }
+    const string& getBase() const { return log.getBase(); }
+};
+
+#endif
@@ -4,20 +4,25 @@
 
 #include "Common.h"
 #include "Map.h"
+#include "IndexedHeap.h"
 #include <vector>
-#include <queue>
 #include <unordered_map>
 #include <algorithm>
 #include <functional>
+#include <cstdint>
+#include <iomanip>
+#include <mutex>
+#include <cstring>
 using namespace std;
 // pathfinding
 struct PathNode {
     Vector3D pos;
     double gCost, hCost;
     int parentIdx;
+    bool closed;
     
     PathNode(Vector3D p = Vector3D(), double g = 0, double h = 0, int parent = -1)
-        : pos(p), gCost(g), hCost(h), parentIdx(parent) {}
+        : pos(p), gCost(g), hCost(h), parentIdx(parent), closed(false) {}
     
     double fCost() const { return gCost + hCost; }
     
@@ -26,6 +31,163 @@ struct PathNode {
     }
 };
 
+// 26-connected moves with their length in grid steps (shared by the lattice planners)
+struct NeighborOffset {
+    int dx, dy, dz;
+    double cost;
+};
+
+constexpr double kStepStraight = 1.0;
+constexpr double kStepDiagonal = 1.4142135623730951;   // sqrt(2)
+constexpr double kStepCorner = 1.7320508075688772;     // sqrt(3)
+
+constexpr NeighborOffset kNeighborOffsets[26] = {
+    {-1, -1, -1, kStepCorner},
+    {-1, -1,  0, kStepDiagonal},
+    {-1, -1,  1, kStepCorner},
+    {-1,  0, -1, kStepDiagonal},
+    {-1,  0,  0, kStepStraight},
+    {-1,  0,  1, kStepDiagonal},
+    {-1,  1, -1, kStepCorner},
+    {-1,  1,  0, kStepDiagonal},
+    {-1,  1,  1, kStepCorner},
+    { 0, -1, -1, kStepDiagonal},
+    { 0, -1,  0, kStepStraight},
+    { 0, -1,  1, kStepDiagonal},
+    { 0,  0, -1, kStepStraight},
+    { 0,  0,  1, kStepStraight},
+    { 0,  1, -1, kStepDiagonal},
+    { 0,  1,  0, kStepStraight},
+    { 0,  1,  1, kStepDiagonal},
+    { 1, -1, -1, kStepCorner},
+    { 1, -1,  0, kStepDiagonal},
+    { 1, -1,  1, kStepCorner},
+    { 1,  0, -1, kStepDiagonal},
+    { 1,  0,  0, kStepStraight},
+    { 1,  0,  1, kStepDiagonal},
+    { 1,  1, -1, kStepCorner},
+    { 1,  1,  0, kStepDiagonal},
+    { 1,  1,  1, kStepCorner}
+};
+
+// per-query search counters (see getLastStats on the planners)
+struct SearchStats {
+    long expansions;        // nodes closed
+    long pushes;            // entries inserted into the open set
+    long decreaseKeys;      // in-place priority improvements
+    long stalePops;         // superseded duplicates popped and skipped
+    size_t peakOpenSize;
+    double pathCost;        // lattice cost of the path found, before smoothing (0 = none)
+    long segmentChecks;     // line-of-sight tests (isSegmentClear) during search and smoothing
+    
+    SearchStats() { reset(); }
+    
+    void reset() {
+        expansions = pushes = decreaseKeys = stalePops = 0;
+        peakOpenSize = 0;
+        pathCost = 0;
+        segmentChecks = 0;
+    }
+    
+    void notePush(size_t openSize) {
+        pushes++;
+        if (openSize > peakOpenSize) peakOpenSize = openSize;
+    }
+    
+    double pushesPerExpansion() const {
+        return expansions > 0 ? (double)pushes / expansions : 0.0;
+    }
+    
+    void add(const SearchStats& other) {
+        expansions += other.expansions;
+        pushes += other.pushes;
+        decreaseKeys += other.decreaseKeys;
+        stalePops += other.stalePops;
+        if (other.peakOpenSize > peakOpenSize) peakOpenSize = other.peakOpenSize;
+        pathCost += other.pathCost;
+        segmentChecks += other.segmentChecks;
+    }
+};
+
+constexpr uint64_t kEmptyCellKey = ~0ULL;
+
+// Open-addressing map from packed cell key to an int index.
+// clear() only touches the slots used since the last clear, so a reused table
+// costs O(nodes touched) per search instead of O(capacity).
+class CellIndexTable {
+private:
+    vector<uint64_t> keys;
+    vector<int> values;
+    vector<size_t> used;
+    size_t mask;
+    
+    static size_t slotFor(uint64_t key, size_t m) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return (size_t)key & m;
+    }
+    
+    void grow() {
+        vector<uint64_t> oldKeys;
+        vector<int> oldValues;
+        vector<size_t> oldUsed;
+        oldKeys.swap(keys);
+        oldValues.swap(values);
+        oldUsed.swap(used);
+        size_t capacity = (mask + 1) * 2;
+        keys.assign(capacity, kEmptyCellKey);
+        values.assign(capacity, -1);
+        mask = capacity - 1;
+        used.reserve(oldUsed.capacity());
+        for (size_t slot : oldUsed) insert(oldKeys[slot], oldValues[slot]);
+    }
+    
+public:
+    CellIndexTable(size_t capacity = 1024) : keys(capacity, kEmptyCellKey), values(capacity, -1), mask(capacity - 1) {}
+    
+    int find(uint64_t key) const {
+        for (size_t slot = slotFor(key, mask); ; slot = (slot + 1) & mask) {
+            if (keys[slot] == key) return values[slot];
+            if (keys[slot] == kEmptyCellKey) return -1;
+        }
+    }
+    
+    void insert(uint64_t key, int value) {
+        if ((used.size() + 1) * 2 > mask + 1) grow();
+        size_t slot = slotFor(key, mask);
+        while (keys[slot] != kEmptyCellKey && keys[slot] != key) slot = (slot + 1) & mask;
+        if (keys[slot] == kEmptyCellKey) used.push_back(slot);
+        keys[slot] = key;
+        values[slot] = value;
+    }
+    
+    void clear() {
+        for (size_t slot : used) {
+            keys[slot] = kEmptyCellKey;
+            values[slot] = -1;
+        }
+        used.clear();
+    }
+    
+    size_t size() const { return used.size(); }
+};
+
+// Search state kept between findPath calls so steady-state queries do not allocate
+struct SearchWorkspace {
+    IndexedHeap openList;           // node indices keyed by f, with decrease-key
+    vector<OpenEntry> lazyOpenList; // push_heap duplicates when the lazy open set is selected
+    vector<PathNode> nodePool;      // one node per visited cell
+    CellIndexTable cells;           // cell key -> nodePool index
+    
+    void reset() {
+        openList.clear();
+        lazyOpenList.clear();
+        nodePool.clear();
+        cells.clear();
+    }
+};
+
 // abstract pathfinder interface
 class IPathFinder {
 public:
@@ -33,80 +195,447 @@ public:
     virtual ~IPathFinder() {}
 };
 
-// dynamic memory allocation
+// shared post-processing for lattice planners: shortcut waypoints that have line of sight
+// (checks, when given, counts the isSegmentClear calls)
+inline vector<Vector3D> smoothPathOnMap(const Map3D* map, const vector<Vector3D>& path, long* checks = nullptr) {
+    if (path.size() <= 2) return path;
+    vector<Vector3D> smoothed;
+    smoothed.push_back(path[0]);
+    size_t i = 0;
+    while (i < path.size() - 1) {
+        size_t j = path.size() - 1;
+        while (j > i + 1) {
+            if (checks) (*checks)++;
+            if (map->isSegmentClear(path[i], path[j])) {
+                break;
+            }
+            j--;
+        }
+        smoothed.push_back(path[j]);
+        i = j;
+    }
+    return smoothed;
+}
+
+// fallback route when the search gives up: climb, cruise above every obstacle, descend
+inline vector<Vector3D> safeAltitudePath(const Map3D* map, const Vector3D& start, const Vector3D& end) {
+    double safeAlt = map->getSafeAltitude();
+    vector<Vector3D> path;
+    path.push_back(start);
+    path.push_back(Vector3D(start.getX(), start.getY(), safeAlt));
+    path.push_back(Vector3D(end.getX(), end.getY(), safeAlt));
+    path.push_back(end);
+    return path;
+}
+
+inline double pathLength(const vector<Vector3D>& path) {
+    double total = 0;
+    for (size_t i = 1; i < path.size(); i++) {
+        total += path[i-1].distanceTo(path[i]);
+    }
+    return total;
+}
+
+// cache key: start/end quantized to a fixed resolution
+struct PathCacheKey {
+    int q[6];
+
+    PathCacheKey() { for (int i = 0; i < 6; i++) q[i] = 0; }
+    PathCacheKey(const Vector3D& start, const Vector3D& end, double quantum) {
+        q[0] = quantize(start.getX(), quantum);
+        q[1] = quantize(start.getY(), quantum);
+        q[2] = quantize(start.getZ(), quantum);
+        q[3] = quantize(end.getX(), quantum);
+        q[4] = quantize(end.getY(), quantum);
+        q[5] = quantize(end.getZ(), quantum);
+    }
+
+    static int quantize(double v, double quantum) { return (int)floor(v / quantum + 0.5); }
+
+    bool operator==(const PathCacheKey& other) const {
+        for (int i = 0; i < 6; i++) {
+            if (q[i] != other.q[i]) return false;
+        }
+        return true;
+    }
+};
+
+struct PathCacheKeyHash {
+    size_t operator()(const PathCacheKey& k) const {
+        // FNV-1a over the six quantized coordinates
+        uint64_t h = 1469598103934665603ULL;
+        for (int i = 0; i < 6; i++) {
+            h ^= (uint32_t)k.q[i];
+            h *= 1099511628211ULL;
+        }
+        return (size_t)h;
+    }
+};
+
+// how cached waypoints are stored in the cache arena
+enum WaypointEncoding {
+    WAYPOINT_DOUBLE,    // 24 bytes per waypoint, exact
+    WAYPOINT_FLOAT,     // 12 bytes, about 7 significant digits
+    WAYPOINT_INT16      // 6 bytes, offsets from the first waypoint in 1/64 units (within 1/128)
+};
+
+inline size_t waypointBytes(WaypointEncoding e) {
+    return e == WAYPOINT_DOUBLE ? 3 * sizeof(double) : e == WAYPOINT_FLOAT ? 3 * sizeof(float) : 3 * sizeof(int16_t);
+}
+
+inline const char* waypointEncodingName(WaypointEncoding e) {
+    return e == WAYPOINT_DOUBLE ? "double" : e == WAYPOINT_FLOAT ? "float32" : "int16";
+}
+
+// One cached path: a handle (offset, count, encoding) into the cache's
+// waypoint arena plus its LRU links. Entries own no memory, so they are
+// moved, never deep-copied.
 struct PathCacheEntry {
-    Vector3D* waypoints;    // Dynamic array of waypoints
+    size_t offset;              // byte offset of the first waypoint in the arena
     int waypointCount;
+    WaypointEncoding encoding;
     double totalDistance;
+    Vector3D origin;            // first waypoint, exact; int16 offsets are relative to it
+    PathCacheKey key;
+    int prev, next;             // LRU links (slot indices, -1 = none)
+
+    PathCacheEntry() : offset(0), waypointCount(0), encoding(WAYPOINT_DOUBLE), totalDistance(0.0), prev(-1), next(-1) {}
+
+    PathCacheEntry(const PathCacheEntry&) = delete;
+    PathCacheEntry& operator=(const PathCacheEntry&) = delete;
+    PathCacheEntry(PathCacheEntry&&) = default;
+    PathCacheEntry& operator=(PathCacheEntry&&) = default;
+
+    size_t payloadBytes() const { return waypointCount * waypointBytes(encoding); }
+};
+
+// Lookup-first path cache: hashed O(1) lookup, LRU eviction under a byte budget,
+// and automatic invalidation whenever the map revision changes.
+// Waypoints of every entry live in one byte arena; an evicted entry leaves
+// a hole that is reclaimed by compacting the arena when it is full and the
+// holes would make room, or make up a quarter of it. Storing a path is
+// amortized a few memcpys and no allocation.
+// The budget is charged the encoded waypoints plus a fixed per-entry
+// overhead (entry slot and index node).
+// Every public method takes the cache lock, so one cache can back several planners
+// running on different threads.
+class PathCache {
+private:
+    static const int kInt16Scale = 64;
+
+    mutable mutex guard;
+    vector<PathCacheEntry> entries;     // slots, reused through freeSlots
+    vector<int> freeSlots;
+    unordered_map<PathCacheKey, int, PathCacheKeyHash> index;
+    vector<unsigned char> arena;
+    size_t arenaUsed;           // bytes handed out (live + holes)
+    size_t arenaHoles;          // bytes of evicted entries not yet compacted
+    int lruHead, lruTail;       // most recently used at head
+    size_t byteBudget;
+    size_t bytesUsed;
+    double quantum;
+    WaypointEncoding encoding;
+    unsigned long mapRevision;
+    
+    long hits, misses, evictions, invalidations, compactions;
+    
+    // budget charge beyond the waypoints: the slot plus an index node and bucket
+    static size_t entryOverhead() {
+        return sizeof(PathCacheEntry) + sizeof(PathCacheKey) + sizeof(int) + 3 * sizeof(void*);
+    }
+    
+    void unlink(int slot) {
+        PathCacheEntry& e = entries[slot];
+        if (e.prev != -1) entries[e.prev].next = e.next; else lruHead = e.next;
+        if (e.next != -1) entries[e.next].prev = e.prev; else lruTail = e.prev;
+        e.prev = e.next = -1;
+    }
+    
+    void pushFront(int slot) {
+        PathCacheEntry& e = entries[slot];
+        e.prev = -1;
+        e.next = lruHead;
+        if (lruHead != -1) entries[lruHead].prev = slot;
+        lruHead = slot;
+        if (lruTail == -1) lruTail = slot;
+    }
+    
+    void evict(int slot) {
+        PathCacheEntry& e = entries[slot];
+        unlink(slot);
+        index.erase(e.key);
+        bytesUsed -= e.payloadBytes() + entryOverhead();
+        arenaHoles += e.payloadBytes();
+        e.waypointCount = 0;
+        freeSlots.push_back(slot);
+    }
+    
+    int allocateSlot() {
+        if (!freeSlots.empty()) {
+            int slot = freeSlots.back();
+            freeSlots.pop_back();
+            return slot;
+        }
+        entries.emplace_back();
+        return (int)entries.size() - 1;
+    }
+    
+    // slide live waypoints down over the holes, in arena order
+    void compact() {
+        vector<int> live;
+        live.reserve(index.size());
+        for (const auto& p : index) live.push_back(p.second);
+        sort(live.begin(), live.end(), [&](int a, int b) { return entries[a].offset < entries[b].offset; });
+        size_t top = 0;
+        for (int slot : live) {
+            PathCacheEntry& e = entries[slot];
+            if (e.offset != top) memmove(arena.data() + top, arena.data() + e.offset, e.payloadBytes());
+            e.offset = top;
+            top += e.payloadBytes();
+        }
+        arenaUsed = top;
+        arenaHoles = 0;
+        compactions++;
+    }
     
-    // constructor
-    PathCacheEntry() : waypoints(nullptr), waypointCount(0), totalDistance(0.0) {}
-    
-    // deep copy
-    PathCacheEntry(const PathCacheEntry& other) {
-        waypointCount = other.waypointCount;
-        totalDistance = other.totalDistance;
-        if (other.waypoints && waypointCount > 0) {
-            waypoints = new Vector3D[waypointCount];
-            for (int i = 0; i < waypointCount; i++) {
-                waypoints[i] = other.waypoints[i];
+    // arena space for n more bytes
+    size_t reserveArena(size_t n) {
+        if (arenaUsed + n > arena.size()) {
+            if (arenaHoles > 0 && (arenaHoles >= n || arenaHoles * 4 >= arenaUsed)) compact();
+            if (arenaUsed + n > arena.size()) arena.resize(max(arena.size() * 2, arenaUsed + n));
+        }
+        size_t offset = arenaUsed;
+        arenaUsed += n;
+        return offset;
+    }
+    
+    // int16 needs every offset from the first waypoint in range; otherwise float32
+    WaypointEncoding encodingFor(const vector<Vector3D>& path) const {
+        if (encoding != WAYPOINT_INT16) return encoding;
+        const double limit = 32767.0 / kInt16Scale;
+        for (const auto& p : path) {
+            if (fabs(p.getX() - path[0].getX()) > limit || fabs(p.getY() - path[0].getY()) > limit ||
+                fabs(p.getZ() - path[0].getZ()) > limit) {
+                return WAYPOINT_FLOAT;
             }
-        } else {
-            waypoints = nullptr;
         }
+        return WAYPOINT_INT16;
     }
     
-    // assignment operator
-    PathCacheEntry& operator=(const PathCacheEntry& other) {
-        if (this != &other) {
-            // delete old data
-            delete[] waypoints;
-            
-            // copy new data
-            waypointCount = other.waypointCount;
-            totalDistance = other.totalDistance;
-            if (other.waypoints && waypointCount > 0) {
-                waypoints = new Vector3D[waypointCount];
-                for (int i = 0; i < waypointCount; i++) {
-                    waypoints[i] = other.waypoints[i];
-                }
+    void encode(const PathCacheEntry& e, const vector<Vector3D>& path) {
+        unsigned char* out = arena.data() + e.offset;
+        for (const auto& p : path) {
+            if (e.encoding == WAYPOINT_DOUBLE) {
+                double v[3] = {p.getX(), p.getY(), p.getZ()};
+                memcpy(out, v, sizeof(v));
+            } else if (e.encoding == WAYPOINT_FLOAT) {
+                float v[3] = {(float)p.getX(), (float)p.getY(), (float)p.getZ()};
+                memcpy(out, v, sizeof(v));
             } else {
-                waypoints = nullptr;
+                int16_t v[3] = {(int16_t)lround((p.getX() - e.origin.getX()) * kInt16Scale),
+                                (int16_t)lround((p.getY() - e.origin.getY()) * kInt16Scale),
+                                (int16_t)lround((p.getZ() - e.origin.getZ()) * kInt16Scale)};
+                memcpy(out, v, sizeof(v));
             }
+            out += waypointBytes(e.encoding);
+        }
+    }
+    
+    void decode(const PathCacheEntry& e, vector<Vector3D>& path) const {
+        path.resize(e.waypointCount);
+        const unsigned char* in = arena.data() + e.offset;
+        for (int i = 0; i < e.waypointCount; i++) {
+            if (e.encoding == WAYPOINT_DOUBLE) {
+                double v[3];
+                memcpy(v, in, sizeof(v));
+                path[i] = Vector3D(v[0], v[1], v[2]);
+            } else if (e.encoding == WAYPOINT_FLOAT) {
+                float v[3];
+                memcpy(v, in, sizeof(v));
+                path[i] = Vector3D(v[0], v[1], v[2]);
+            } else {
+                int16_t v[3];
+                memcpy(v, in, sizeof(v));
+                path[i] = e.origin + Vector3D(v[0], v[1], v[2]) / kInt16Scale;
+            }
+            in += waypointBytes(e.encoding);
+        }
+        if (e.waypointCount > 0) path[0] = e.origin;
+    }
+    
+    void clearUnlocked() {
+        entries.clear();
+        freeSlots.clear();
+        index.clear();
+        arenaUsed = arenaHoles = 0;
+        lruHead = lruTail = -1;
+        bytesUsed = 0;
+    }
+    
+    // steal other's contents; both locks held (or other unreachable)
+    void moveFrom(PathCache& other) {
+        entries = move(other.entries);
+        freeSlots = move(other.freeSlots);
+        index = move(other.index);
+        arena = move(other.arena);
+        arenaUsed = other.arenaUsed;
+        arenaHoles = other.arenaHoles;
+        lruHead = other.lruHead;
+        lruTail = other.lruTail;
+        byteBudget = other.byteBudget;
+        bytesUsed = other.bytesUsed;
+        quantum = other.quantum;
+        encoding = other.encoding;
+        mapRevision = other.mapRevision;
+        hits = other.hits;
+        misses = other.misses;
+        evictions = other.evictions;
+        invalidations = other.invalidations;
+        compactions = other.compactions;
+        other.clearUnlocked();
+    }
+    
+public:
+    PathCache(size_t budget = 256 * 1024, double q = 0.01, WaypointEncoding enc = WAYPOINT_DOUBLE)
+        : arenaUsed(0), arenaHoles(0), lruHead(-1), lruTail(-1), byteBudget(budget),
+          bytesUsed(0), quantum(q), encoding(enc), mapRevision(0),
+          hits(0), misses(0), evictions(0), invalidations(0), compactions(0) {}
+    
+    PathCache(const PathCache&) = delete;
+    PathCache& operator=(const PathCache&) = delete;
+    
+    PathCache(PathCache&& other) {
+        lock_guard<mutex> lock(other.guard);
+        moveFrom(other);
+    }
+    
+    PathCache& operator=(PathCache&& other) {
+        if (this != &other) {
+            unique_lock<mutex> mine(guard, defer_lock), theirs(other.guard, defer_lock);
+            std::lock(mine, theirs);
+            moveFrom(other);
         }
         return *this;
     }
     
-    // free memory
-    ~PathCacheEntry() {
-        delete[] waypoints;
-        waypoints = nullptr;
+    // drop every entry if the map changed since they were computed
+    void syncRevision(unsigned long revision) {
+        lock_guard<mutex> lock(guard);
+        if (revision == mapRevision) return;
+        if (!index.empty()) invalidations++;
+        clearUnlocked();
+        mapRevision = revision;
     }
     
-    // Store path in cache
-    void storePath(const vector<Vector3D>& path, double dist) {
-        delete[] waypoints;  // Clear old data
+    // decodes the cached path into 'path' (the entry may be evicted once the lock is released)
+    bool lookup(const Vector3D& start, const Vector3D& end, vector<Vector3D>& path) {
+        lock_guard<mutex> lock(guard);
+        auto it = index.find(PathCacheKey(start, end, quantum));
+        if (it == index.end()) {
+            misses++;
+            return false;
+        }
+        hits++;
+        unlink(it->second);
+        pushFront(it->second);
+        decode(entries[it->second], path);
+        return true;
+    }
+    
+    void store(const Vector3D& start, const Vector3D& end,
+               const vector<Vector3D>& path, double distance) {
+        lock_guard<mutex> lock(guard);
+        WaypointEncoding enc = encodingFor(path);
+        size_t needed = path.size() * waypointBytes(enc) + entryOverhead();
+        if (needed > byteBudget) return;
         
-        waypointCount = (int)path.size();
-        totalDistance = dist;
+        PathCacheKey key(start, end, quantum);
+        auto it = index.find(key);
+        if (it != index.end()) evict(it->second);
         
-        if (waypointCount > 0) {
-            waypoints = new Vector3D[waypointCount];  // Dynamic allocation
-            for (int i = 0; i < waypointCount; i++) {
-                waypoints[i] = path[i];
-            }
-        } else {
-            waypoints = nullptr;
+        while (bytesUsed + needed > byteBudget && lruTail != -1) {
+            evict(lruTail);
+            evictions++;
         }
+        
+        int slot = allocateSlot();
+        size_t offset = reserveArena(path.size() * waypointBytes(enc));
+        PathCacheEntry& e = entries[slot];
+        e.offset = offset;
+        e.waypointCount = (int)path.size();
+        e.encoding = enc;
+        e.totalDistance = distance;
+        e.origin = path.empty() ? Vector3D() : path[0];
+        e.key = key;
+        encode(e, path);
+        pushFront(slot);
+        index[key] = slot;
+        bytesUsed += needed;
     }
     
-    // Retrieve path from cache
-    vector<Vector3D> retrievePath() const {
-        vector<Vector3D> path;
-        for (int i = 0; i < waypointCount; i++) {
-            path.push_back(waypoints[i]);
+    void clear() {
+        lock_guard<mutex> lock(guard);
+        clearUnlocked();
+    }
+    
+    void setBudget(size_t bytes) {
+        lock_guard<mutex> lock(guard);
+        byteBudget = bytes;
+        while (bytesUsed > byteBudget && lruTail != -1) {
+            evict(lruTail);
+            evictions++;
         }
-        return path;
+    }
+    
+    // applies to paths stored from now on; drops the current entries
+    void setEncoding(WaypointEncoding enc) {
+        lock_guard<mutex> lock(guard);
+        encoding = enc;
+        clearUnlocked();
+    }
+    
+    // heap actually held: arena, slots, free list and index
+    size_t memoryBytes() const {
+        lock_guard<mutex> lock(guard);
+        return arena.capacity() + entries.capacity() * sizeof(PathCacheEntry) + freeSlots.capacity() * sizeof(int) +
+               index.bucket_count() * sizeof(void*) +
+               index.size() * (sizeof(PathCacheKey) + sizeof(int) + 2 * sizeof(void*));
+    }
+    
+    size_t getBudget() const { lock_guard<mutex> lock(guard); return byteBudget; }
+    size_t getBytesUsed() const { lock_guard<mutex> lock(guard); return bytesUsed; }
+    int getEntryCount() const { lock_guard<mutex> lock(guard); return (int)index.size(); }
+    long getHits() const { lock_guard<mutex> lock(guard); return hits; }
+    long getMisses() const { lock_guard<mutex> lock(guard); return misses; }
+    WaypointEncoding getEncoding() const { lock_guard<mutex> lock(guard); return encoding; }
+    
+    void printStats() const {
+        size_t heapBytes = memoryBytes();
+        lock_guard<mutex> lock(guard);
+        long lookups = hits + misses;
+        size_t totalWaypoints = 0, payload = 0;
+        for (const auto& p : index) {
+            totalWaypoints += entries[p.second].waypointCount;
+            payload += entries[p.second].payloadBytes();
+        }
+        cout << "Path Cache Statistics:\n";
+        cout << "  Entries: " << index.size() << " (slots " << entries.size() << ", " << freeSlots.size() << " free)\n";
+        cout << "  Budget Used: " << bytesUsed << "/" << byteBudget << " bytes\n";
+        cout << "  Total Waypoints Cached: " << totalWaypoints << " (" << waypointEncodingName(encoding) << ", "
+             << payload << " bytes)\n";
+        cout << "  Arena: " << arenaUsed << "/" << arena.capacity() << " bytes, " << arenaHoles
+             << " in holes, " << compactions << " compactions\n";
+        cout << "  Heap Held: " << heapBytes << " bytes";
+        if (totalWaypoints > 0) {
+            cout << " (" << fixed << setprecision(1) << (double)heapBytes / totalWaypoints << " per waypoint)";
+        }
+        cout << "\n";
+        cout << "  Hits: " << hits << "  Misses: " << misses;
+        if (lookups > 0) {
+            cout << "  (hit rate " << fixed << setprecision(1) << (100.0 * hits / lookups) << "%)";
+        }
+        cout << "\n";
+        cout << "  Evictions: " << evictions << "  Invalidations: " << invalidations << "\n";
     }
 };
 
@@ -115,127 +644,84 @@ class PathFinder3D : public IPathFinder {
 private:
     const Map3D* map;
     double gridStep;
-    PathCacheEntry* pathCache;  // Dynamic memory for path cache
-    int cacheSize;
-    int cacheCapacity;
-    
-    inline string posKey(const Vector3D& v) const {
-        return to_string((int)v.getX()) + "," + 
-               to_string((int)v.getY()) + "," + 
-               to_string((int)v.getZ());
-    }
-    
-    string getCacheKey(const Vector3D& start, const Vector3D& end) const {
-        return posKey(start) + "->" + posKey(end);
-    }
-    
-    vector<Vector3D> getNeighbors(const Vector3D& pos) const {
-        vector<Vector3D> neighbors;
-        // 26-directional movement in 3D
-        for (int dx = -1; dx <= 1; dx++) {
-            for (int dy = -1; dy <= 1; dy++) {
-                for (int dz = -1; dz <= 1; dz++) {
-                    if (dx == 0 && dy == 0 && dz == 0) continue;
-                    Vector3D next(pos.getX() + dx * gridStep,
-                                  pos.getY() + dy * gridStep,
-                                  pos.getZ() + dz * gridStep);
-                    if (!map->isBlocked(next)) {
-                        neighbors.push_back(next);
-                    }
-                }
-            }
-        }
-        return neighbors;
-    }
-    
-    vector<Vector3D> smoothPath(const vector<Vector3D>& path) const {
-        if (path.size() <= 2) return path;
-        vector<Vector3D> smoothed;
-        smoothed.push_back(path[0]);
-        size_t i = 0;
-        while (i < path.size() - 1) {
-            size_t j = path.size() - 1;
-            while (j > i + 1) {
-                if (map->isPathClear(path[i], path[j], 0.5)) {
-                    break;
-                }
-                j--;
-            }
-            smoothed.push_back(path[j]);
-            i = j;
+    PathCache localCache;
+    PathCache* sharedCache;     // set when several planners share one cache (see BatchPlanner)
+    bool useOccupancy;          // current query can use the map's voxel bitmap
+    int maxIterations;          // expansions before falling back to safeAltitudePath
+    bool lazyOpenSet;           // duplicate pushes + stale pops instead of decrease-key (A/B only)
+    
+    SearchWorkspace workspace;
+    SearchStats lastStats;
+    Vector3D anchor;            // lattice origin of the current query (its start point)
+    
+    // pack lattice coordinates relative to the query start into one 64-bit key
+    inline uint64_t posKey(const Vector3D& v) const {
+        const int bias = 1 << 20;
+        uint64_t i = (uint64_t)((int)floor((v.getX() - anchor.getX()) / gridStep + 0.5) + bias);
+        uint64_t j = (uint64_t)((int)floor((v.getY() - anchor.getY()) / gridStep + 0.5) + bias);
+        uint64_t k = (uint64_t)((int)floor((v.getZ() - anchor.getZ()) / gridStep + 0.5) + bias);
+        return (i & 0x1FFFFF) | ((j & 0x1FFFFF) << 21) | ((k & 0x1FFFFF) << 42);
+    }
+    
+    // calls visit(neighbor, stepCost) for every free neighbor; no temporary containers
+    template <typename Visit>
+    void forEachNeighbor(const Vector3D& pos, Visit visit) const {
+        // bit tests against the baked occupancy when this query's lattice matches it
+        int vi = 0, vj = 0, vk = 0;
+        bool bitTests = useOccupancy && map->getOccupancy().latticeCoords(pos, vi, vj, vk);
+        for (const NeighborOffset& o : kNeighborOffsets) {
+            Vector3D next(pos.getX() + o.dx * gridStep,
+                          pos.getY() + o.dy * gridStep,
+                          pos.getZ() + o.dz * gridStep);
+            bool blocked = bitTests
+                ? map->getOccupancy().isBlocked(vi + o.dx, vj + o.dy, vk + o.dz)
+                : map->isBlocked(next);
+            if (!blocked) visit(next, o.cost * gridStep);
         }
-        return smoothed;
     }
     
+    vector<Vector3D> smoothPath(const vector<Vector3D>& path) {
+        return smoothPathOnMap(map, path, &lastStats.segmentChecks);
+    }
+    
+    PathCache& cache() { return sharedCache ? *sharedCache : localCache; }
+    const PathCache& cache() const { return sharedCache ? *sharedCache : localCache; }
+    
     void addToCache(const Vector3D& start, const Vector3D& end, 
                     const vector<Vector3D>& path, double distance) {
-        if (cacheSize >= cacheCapacity) {
-            // expand cache if full (dynamic reallocation)
-            int newCapacity = cacheCapacity * 2;
-            PathCacheEntry* newCache = new PathCacheEntry[newCapacity];
-            
-            // copy old entries
-            for (int i = 0; i < cacheSize; i++) {
-                newCache[i] = pathCache[i];
-            }
-            
-            // delete old cache and use new one
-            delete[] pathCache;
-            pathCache = newCache;
-            cacheCapacity = newCapacity;
-        }
-        
-        // store new entry
-        pathCache[cacheSize].storePath(path, distance);
-        cacheSize++;
+        cache().store(start, end, path, distance);
     }
 
 public:
-    PathFinder3D(const Map3D* m, double step = 1.0) 
-        : map(m), gridStep(step), cacheSize(0), cacheCapacity(10) {
-        // Dynamic memory allocation for cache
-        pathCache = new PathCacheEntry[cacheCapacity];
-    }
+    PathFinder3D(const Map3D* m, double step = 1.0, size_t cacheBudget = 256 * 1024) 
+        : map(m), gridStep(step), localCache(cacheBudget), sharedCache(nullptr), useOccupancy(false),
+          maxIterations(10000), lazyOpenSet(false) {}
     
-    // Destructor to free dynamically allocated memory
-    ~PathFinder3D() {
-        delete[] pathCache;
-        pathCache = nullptr;
-    }
-    
-    // Copy constructor (deep copy)
-    PathFinder3D(const PathFinder3D& other) 
-        : map(other.map), gridStep(other.gridStep), 
-          cacheSize(other.cacheSize), cacheCapacity(other.cacheCapacity) {
-        pathCache = new PathCacheEntry[cacheCapacity];
-        for (int i = 0; i < cacheSize; i++) {
-            pathCache[i] = other.pathCache[i];
-        }
-    }
+    // byte budget for cached paths (0 disables caching)
+    void setCacheBudget(size_t bytes) { cache().setBudget(bytes); }
+    void clearCache() { cache().clear(); }
+    void setMaxIterations(int n) { maxIterations = n; }
+    // lazy binary heap open set, kept to measure the indexed heap against (benchmark 6)
+    void setLazyOpenSet(bool lazy) { lazyOpenSet = lazy; }
+    // waypoint storage for cached paths (drops current entries)
+    void setCacheEncoding(WaypointEncoding enc) { cache().setEncoding(enc); }
     
-    // Assignment operator
-    PathFinder3D& operator=(const PathFinder3D& other) {
-        if (this != &other) {
-            delete[] pathCache;
-            
-            map = other.map;
-            gridStep = other.gridStep;
-            cacheSize = other.cacheSize;
-            cacheCapacity = other.cacheCapacity;
-            
-            pathCache = new PathCacheEntry[cacheCapacity];
-            for (int i = 0; i < cacheSize; i++) {
-                pathCache[i] = other.pathCache[i];
-            }
-        }
-        return *this;
-    }
+    // use an external (thread-safe) cache instead of this planner's own; nullptr reverts
+    void setSharedCache(PathCache* shared) { sharedCache = shared; }
     
     vector<Vector3D> findPath(const Vector3D& start, const Vector3D& end) override {
         vector<Vector3D> path;
         
+        lastStats.reset();
+        
+        // Serve repeat routes from the cache (flushed if the map changed)
+        cache().syncRevision(map->getRevision());
+        if (cache().lookup(start, end, path)) {
+            return path;
+        }
+        
         // Quick check for direct path
-        if (map->isPathClear(start, end)) {
+        if (map->isSegmentClear(start, end)) {
             path.push_back(start);
             path.push_back(end);
             double dist = start.distanceTo(end);
@@ -243,38 +729,63 @@ public:
             return path;
         }
         
-        // A* algorithm using STL priority_queue
-        priority_queue<PathNode, vector<PathNode>, greater<PathNode>> openSet;
-        unordered_map<string, double> closedSet;
-        vector<PathNode> allNodes;
+        useOccupancy = map->getOccupancy().matches(start, gridStep, 0.5);
+        
+        anchor = start;
         
-        PathNode startNode(start, 0, start.distanceTo(end), -1);
-        openSet.push(startNode);
-        allNodes.push_back(startNode);
+        // A* over the reusable workspace: the heap holds node indices, nodes live in the pool
+        workspace.reset();
+        IndexedHeap& openSet = workspace.openList;
+        vector<OpenEntry>& lazyOpen = workspace.lazyOpenList;
+        vector<PathNode>& allNodes = workspace.nodePool;
+        
+        auto pushOpen = [&](int idx) {
+            if (lazyOpenSet) {
+                lazyOpen.push_back(OpenEntry(allNodes[idx].fCost(), idx));
+                push_heap(lazyOpen.begin(), lazyOpen.end(), greater<OpenEntry>());
+                lastStats.notePush(lazyOpen.size());
+            } else {
+                openSet.push(idx, allNodes[idx].fCost());
+                lastStats.notePush(openSet.size());
+            }
+        };
+        // pool index of the next node to expand, -1 once the open set is exhausted
+        auto popOpen = [&]() -> int {
+            if (!lazyOpenSet) return openSet.empty() ? -1 : openSet.pop();
+            while (!lazyOpen.empty()) {
+                pop_heap(lazyOpen.begin(), lazyOpen.end(), greater<OpenEntry>());
+                OpenEntry top = lazyOpen.back();
+                lazyOpen.pop_back();
+                const PathNode& node = allNodes[top.node];
+                if (!node.closed && top.f <= node.fCost()) return top.node;
+                lastStats.stalePops++;
+            }
+            return -1;
+        };
+        
+        allNodes.push_back(PathNode(start, 0, start.distanceTo(end), -1));
+        workspace.cells.insert(posKey(start), 0);
+        pushOpen(0);
         
         int iterations = 0;
-        const int maxIter = 10000;
         
-        while (!openSet.empty() && iterations < maxIter) {
+        while (iterations < maxIterations) {
+            // the heap hands back the pool index of the node it popped, so
+            // parents below point at the node actually expanded
+            int currentIdx = popOpen();
+            if (currentIdx == -1) break;
             iterations++;
-            PathNode current = openSet.top();
-            openSet.pop();
-            
-            string key = posKey(current.pos);
-            if (closedSet.find(key) != closedSet.end()) continue;
-            closedSet[key] = current.gCost;
+            allNodes[currentIdx].closed = true;
+            lastStats.expansions++;
+            Vector3D currentPos = allNodes[currentIdx].pos;
+            double currentG = allNodes[currentIdx].gCost;
             
             // Check if reached destination
-            if (current.pos.distanceTo(end) < gridStep * 1.5) {
-                // Reconstruct path
-                int idx = (int)allNodes.size() - 1;
-                for (size_t i = 0; i < allNodes.size(); i++) {
-                    if (allNodes[i].pos == current.pos) { idx = (int)i; break; }
-                }
-                
-                while (idx != -1 && idx < (int)allNodes.size()) {
+            if (currentPos.distanceTo(end) < gridStep * 1.5) {
+                lastStats.pathCost = currentG + currentPos.distanceTo(end);
+                // Reconstruct path: O(path length), following parent indices from the popped node
+                for (int idx = currentIdx; idx != -1; idx = allNodes[idx].parentIdx) {
                     path.push_back(allNodes[idx].pos);
-                    idx = allNodes[idx].parentIdx;
                 }
                 reverse(path.begin(), path.end());
                 path.push_back(end);
@@ -287,24 +798,32 @@ public:
             }
             
             // Explore neighbors
-            int currentIdx = (int)allNodes.size() - 1;
-            for (const auto& neighbor : getNeighbors(current.pos)) {
-                string nKey = posKey(neighbor);
-                if (closedSet.find(nKey) != closedSet.end()) continue;
-                
-                double newG = current.gCost + current.pos.distanceTo(neighbor);
-                PathNode newNode(neighbor, newG, neighbor.distanceTo(end), currentIdx);
-                openSet.push(newNode);
-                allNodes.push_back(newNode);
-            }
+            forEachNeighbor(currentPos, [&](const Vector3D& neighbor, double stepCost) {
+                uint64_t nKey = posKey(neighbor);
+                double newG = currentG + stepCost;
+                int idx = workspace.cells.find(nKey);
+                if (idx == -1) {
+                    idx = (int)allNodes.size();
+                    allNodes.push_back(PathNode(neighbor, newG, neighbor.distanceTo(end), currentIdx));
+                    workspace.cells.insert(nKey, idx);
+                    pushOpen(idx);
+                    return;
+                }
+                PathNode& node = allNodes[idx];
+                if (node.closed || newG >= node.gCost) return;
+                node.gCost = newG;
+                node.parentIdx = currentIdx;
+                if (lazyOpenSet) {
+                    pushOpen(idx);      // the older entry is skipped when it surfaces
+                } else {
+                    openSet.decreaseKey(idx, node.fCost());
+                    lastStats.decreaseKeys++;
+                }
+            });
         }
         
         // fly high above obstacles
-        double safeAlt = map->getSafeAltitude();
-        path.push_back(start);
-        path.push_back(Vector3D(start.getX(), start.getY(), safeAlt));
-        path.push_back(Vector3D(end.getX(), end.getY(), safeAlt));
-        path.push_back(end);
+        path = safeAltitudePath(map, start, end);
         
         double dist = calculatePathDistance(path);
         addToCache(start, end, path, dist);
@@ -313,24 +832,15 @@ public:
     }
     
     double calculatePathDistance(const vector<Vector3D>& path) const {
-        double total = 0;
-        for (size_t i = 1; i < path.size(); i++) {
-            total += path[i-1].distanceTo(path[i]);
-        }
-        return total;
+        return pathLength(path);
     }
     
+    // counters from the most recent search (cache hits and direct paths leave them at zero)
+    const SearchStats& getLastStats() const { return lastStats; }
+    
     // Get cache statistics
     void printCacheStats() const {
-        cout << "Path Cache Statistics:\n";
-        cout << "  Entries: " << cacheSize << "/" << cacheCapacity << "\n";
-        cout << "  Memory Used: " << (cacheSize * sizeof(PathCacheEntry)) << " bytes\n";
-        
-        int totalWaypoints = 0;
-        for (int i = 0; i < cacheSize; i++) {
-            totalWaypoints += pathCache[i].waypointCount;
-        }
-        cout << "  Total Waypoints Cached: " << totalWaypoints << "\n";
+        cache().printStats();
     }
 };
 
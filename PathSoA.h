@@ -0,0 +1,371 @@
+// PathSoA.h - Structure-of-arrays waypoint storage and vectorized path kernels
+#ifndef PATHSOA_H
+#define PATHSOA_H
+
+#include "Common.h"
+#include <vector>
+#include <cstdlib>
+#include <cstddef>
+#include <cfloat>
+#include <new>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PATHSOA_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+using namespace std;
+
+// GCC/Clang compile single functions for AVX2 without -mavx2 for the whole
+// program; MSVC accepts the intrinsics anywhere.
+#if defined(PATHSOA_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PATHSOA_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define PATHSOA_AVX2
+#endif
+
+// allocator handing out Align-byte aligned blocks, so every array starts on a vector boundary
+template <typename T, size_t Align>
+struct AlignedAllocator {
+    typedef T value_type;
+    template <typename U> struct rebind { typedef AlignedAllocator<U, Align> other; };
+
+    AlignedAllocator() {}
+    template <typename U> AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+    T* allocate(size_t n) {
+        void* p = nullptr;
+#ifdef _WIN32
+        p = _aligned_malloc(n * sizeof(T), Align);
+#else
+        if (posix_memalign(&p, Align, n * sizeof(T)) != 0) p = nullptr;
+#endif
+        if (!p) throw bad_alloc();
+        return (T*)p;
+    }
+
+    void deallocate(T* p, size_t) {
+#ifdef _WIN32
+        _aligned_free(p);
+#else
+        free(p);
+#endif
+    }
+
+    template <typename U> bool operator==(const AlignedAllocator<U, Align>&) const { return true; }
+    template <typename U> bool operator!=(const AlignedAllocator<U, Align>&) const { return false; }
+};
+
+typedef vector<double, AlignedAllocator<double, 32>> AlignedDoubles;
+
+// Waypoints as three parallel coordinate arrays (x[i], y[i], z[i]).
+class PathSoA {
+private:
+    AlignedDoubles xs, ys, zs;
+
+public:
+    PathSoA() {}
+    explicit PathSoA(const vector<Vector3D>& path) { assign(path); }
+
+    void assign(const vector<Vector3D>& path) {
+        clear();
+        reserve(path.size());
+        for (const auto& p : path) push_back(p);
+    }
+
+    void push_back(const Vector3D& p) {
+        xs.push_back(p.getX());
+        ys.push_back(p.getY());
+        zs.push_back(p.getZ());
+    }
+
+    void reserve(size_t n) {
+        xs.reserve(n);
+        ys.reserve(n);
+        zs.reserve(n);
+    }
+
+    void clear() {
+        xs.clear();
+        ys.clear();
+        zs.clear();
+    }
+
+    size_t size() const { return xs.size(); }
+    bool empty() const { return xs.empty(); }
+    Vector3D operator[](size_t i) const { return Vector3D(xs[i], ys[i], zs[i]); }
+
+    vector<Vector3D> toVector() const {
+        vector<Vector3D> path;
+        path.reserve(size());
+        for (size_t i = 0; i < size(); i++) path.push_back((*this)[i]);
+        return path;
+    }
+
+    const double* x() const { return xs.data(); }
+    const double* y() const { return ys.data(); }
+    const double* z() const { return zs.data(); }
+};
+
+struct PathBounds {
+    Vector3D lo, hi;
+};
+
+// One implementation of every kernel. n is the waypoint count.
+struct PathKernelTable {
+    const char* name;
+    double (*length)(const double* x, const double* y, const double* z, size_t n);
+    void (*segments)(const double* x, const double* y, const double* z, size_t n, double* out);     // n - 1 values
+    void (*cumulative)(const double* x, const double* y, const double* z, size_t n, double* out);   // n values, out[0] = 0
+    void (*bounds)(const double* x, const double* y, const double* z, size_t n, double lo[3], double hi[3]);
+    // charge on arrival at each waypoint (n values); returns the first index at or below reserve, or n
+    size_t (*battery)(const double* x, const double* y, const double* z, size_t n, double startCharge,
+                      double ratePerUnit, double reserve, double* out);
+};
+
+// scalar kernels; also the tails of the vector ones
+inline double scalarSegment(const double* x, const double* y, const double* z, size_t i) {
+    double dx = x[i + 1] - x[i], dy = y[i + 1] - y[i], dz = z[i + 1] - z[i];
+    return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+inline double scalarPathLength(const double* x, const double* y, const double* z, size_t n) {
+    double total = 0;
+    for (size_t i = 0; i + 1 < n; i++) total += scalarSegment(x, y, z, i);
+    return total;
+}
+
+inline void scalarSegmentLengths(const double* x, const double* y, const double* z, size_t n, double* out) {
+    for (size_t i = 0; i + 1 < n; i++) out[i] = scalarSegment(x, y, z, i);
+}
+
+inline void scalarCumulativeLength(const double* x, const double* y, const double* z, size_t n, double* out) {
+    if (n == 0) return;
+    out[0] = 0;
+    for (size_t i = 0; i + 1 < n; i++) out[i + 1] = out[i] + scalarSegment(x, y, z, i);
+}
+
+inline void scalarBounds(const double* x, const double* y, const double* z, size_t n, double lo[3], double hi[3]) {
+    lo[0] = lo[1] = lo[2] = DBL_MAX;
+    hi[0] = hi[1] = hi[2] = -DBL_MAX;
+    for (size_t i = 0; i < n; i++) {
+        lo[0] = min(lo[0], x[i]); hi[0] = max(hi[0], x[i]);
+        lo[1] = min(lo[1], y[i]); hi[1] = max(hi[1], y[i]);
+        lo[2] = min(lo[2], z[i]); hi[2] = max(hi[2], z[i]);
+    }
+}
+
+inline size_t scalarBatteryAlongPath(const double* x, const double* y, const double* z, size_t n, double startCharge,
+                                    double ratePerUnit, double reserve, double* out) {
+    size_t firstLow = n;
+    double flown = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (i > 0) flown += scalarSegment(x, y, z, i - 1);
+        out[i] = max(0.0, startCharge - flown * ratePerUnit);
+        if (out[i] <= reserve && firstLow == n) firstLow = i;
+    }
+    return firstLow;
+}
+
+#ifdef PATHSOA_X86
+// AVX2: four segments per step. Lengths are summed in four lanes, so totals
+// can differ from the scalar kernel in the last bits.
+PATHSOA_AVX2 inline __m256d avx2Segments(const double* x, const double* y, const double* z, size_t i) {
+    __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + i + 1), _mm256_loadu_pd(x + i));
+    __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + i + 1), _mm256_loadu_pd(y + i));
+    __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(z + i + 1), _mm256_loadu_pd(z + i));
+    __m256d sq = _mm256_fmadd_pd(dz, dz, _mm256_fmadd_pd(dy, dy, _mm256_mul_pd(dx, dx)));
+    return _mm256_sqrt_pd(sq);
+}
+
+PATHSOA_AVX2 inline double avx2PathLength(const double* x, const double* y, const double* z, size_t n) {
+    if (n < 2) return 0;
+    size_t segs = n - 1, i = 0;
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    // two accumulators hide the sqrt latency
+    for (; i + 8 <= segs; i += 8) {
+        acc0 = _mm256_add_pd(acc0, avx2Segments(x, y, z, i));
+        acc1 = _mm256_add_pd(acc1, avx2Segments(x, y, z, i + 4));
+    }
+    for (; i + 4 <= segs; i += 4) acc0 = _mm256_add_pd(acc0, avx2Segments(x, y, z, i));
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+    double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < segs; i++) total += scalarSegment(x, y, z, i);
+    return total;
+}
+
+PATHSOA_AVX2 inline void avx2SegmentLengths(const double* x, const double* y, const double* z, size_t n, double* out) {
+    if (n < 2) return;
+    size_t segs = n - 1, i = 0;
+    for (; i + 4 <= segs; i += 4) _mm256_storeu_pd(out + i, avx2Segments(x, y, z, i));
+    for (; i < segs; i++) out[i] = scalarSegment(x, y, z, i);
+}
+
+// in-register prefix sum of four lanes: [a, a+b, a+b+c, a+b+c+d]
+PATHSOA_AVX2 inline __m256d avx2PrefixSum(__m256d v) {
+    __m256d zero = _mm256_setzero_pd();
+    v = _mm256_add_pd(v, _mm256_blend_pd(_mm256_permute4x64_pd(v, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x1));
+    v = _mm256_add_pd(v, _mm256_blend_pd(_mm256_permute4x64_pd(v, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x3));
+    return v;
+}
+
+PATHSOA_AVX2 inline void avx2CumulativeLength(const double* x, const double* y, const double* z, size_t n, double* out) {
+    if (n == 0) return;
+    out[0] = 0;
+    if (n < 2) return;
+    size_t segs = n - 1, i = 0;
+    __m256d carry = _mm256_setzero_pd();
+    for (; i + 4 <= segs; i += 4) {
+        __m256d running = _mm256_add_pd(avx2PrefixSum(avx2Segments(x, y, z, i)), carry);
+        _mm256_storeu_pd(out + i + 1, running);
+        carry = _mm256_permute4x64_pd(running, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    for (; i < segs; i++) out[i + 1] = out[i] + scalarSegment(x, y, z, i);
+}
+
+// cumulative length and charge in one pass; the reserve test is a lane mask
+PATHSOA_AVX2 inline size_t avx2BatteryAlongPath(const double* x, const double* y, const double* z, size_t n,
+                                                double startCharge, double ratePerUnit, double reserve, double* out) {
+    if (n == 0) return 0;
+    out[0] = max(0.0, startCharge);
+    size_t firstLow = out[0] <= reserve ? 0 : n;
+    size_t segs = n - 1, i = 0;
+    __m256d carry = _mm256_setzero_pd(), zero = _mm256_setzero_pd();
+    __m256d start = _mm256_set1_pd(startCharge), rate = _mm256_set1_pd(ratePerUnit), low = _mm256_set1_pd(reserve);
+    for (; i + 4 <= segs; i += 4) {
+        __m256d running = _mm256_add_pd(avx2PrefixSum(avx2Segments(x, y, z, i)), carry);
+        carry = _mm256_permute4x64_pd(running, _MM_SHUFFLE(3, 3, 3, 3));
+        __m256d charge = _mm256_max_pd(_mm256_fnmadd_pd(running, rate, start), zero);
+        _mm256_storeu_pd(out + i + 1, charge);
+        if (firstLow == n) {
+            int mask = _mm256_movemask_pd(_mm256_cmp_pd(charge, low, _CMP_LE_OQ));
+            if (mask) firstLow = i + 1 + (mask & 1 ? 0 : mask & 2 ? 1 : mask & 4 ? 2 : 3);
+        }
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, carry);
+    double flown = lanes[0];
+    for (; i < segs; i++) {
+        flown += scalarSegment(x, y, z, i);
+        out[i + 1] = max(0.0, startCharge - flown * ratePerUnit);
+        if (out[i + 1] <= reserve && firstLow == n) firstLow = i + 1;
+    }
+    return firstLow;
+}
+
+PATHSOA_AVX2 inline void avx2Bounds(const double* x, const double* y, const double* z, size_t n, double lo[3], double hi[3]) {
+    scalarBounds(x, y, z, 0, lo, hi);
+    size_t i = 0;
+    if (n >= 4) {
+        __m256d lx = _mm256_loadu_pd(x), ly = _mm256_loadu_pd(y), lz = _mm256_loadu_pd(z);
+        __m256d hx = lx, hy = ly, hz = lz;
+        for (i = 4; i + 4 <= n; i += 4) {
+            __m256d vx = _mm256_loadu_pd(x + i), vy = _mm256_loadu_pd(y + i), vz = _mm256_loadu_pd(z + i);
+            lx = _mm256_min_pd(lx, vx); hx = _mm256_max_pd(hx, vx);
+            ly = _mm256_min_pd(ly, vy); hy = _mm256_max_pd(hy, vy);
+            lz = _mm256_min_pd(lz, vz); hz = _mm256_max_pd(hz, vz);
+        }
+        alignas(32) double lanes[6][4];
+        _mm256_store_pd(lanes[0], lx); _mm256_store_pd(lanes[1], ly); _mm256_store_pd(lanes[2], lz);
+        _mm256_store_pd(lanes[3], hx); _mm256_store_pd(lanes[4], hy); _mm256_store_pd(lanes[5], hz);
+        for (int a = 0; a < 3; a++) {
+            for (int l = 0; l < 4; l++) {
+                lo[a] = min(lo[a], lanes[a][l]);
+                hi[a] = max(hi[a], lanes[3 + a][l]);
+            }
+        }
+    }
+    for (; i < n; i++) {
+        lo[0] = min(lo[0], x[i]); hi[0] = max(hi[0], x[i]);
+        lo[1] = min(lo[1], y[i]); hi[1] = max(hi[1], y[i]);
+        lo[2] = min(lo[2], z[i]); hi[2] = max(hi[2], z[i]);
+    }
+}
+
+inline bool cpuHasAVX2() {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+    bool fma = (info[2] & (1 << 12)) != 0;
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && fma && (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+#endif
+
+inline const PathKernelTable& scalarPathKernels() {
+    static const PathKernelTable table = {"scalar", scalarPathLength, scalarSegmentLengths,
+                                          scalarCumulativeLength, scalarBounds, scalarBatteryAlongPath};
+    return table;
+}
+
+// best table this CPU supports
+inline const PathKernelTable& detectPathKernels() {
+#ifdef PATHSOA_X86
+    static const PathKernelTable avx2 = {"avx2", avx2PathLength, avx2SegmentLengths,
+                                         avx2CumulativeLength, avx2Bounds, avx2BatteryAlongPath};
+    static const bool supported = cpuHasAVX2();
+    if (supported) return avx2;
+#endif
+    return scalarPathKernels();
+}
+
+// table used by the path functions below; chosen once at startup, switchable for benchmarks
+inline const PathKernelTable*& activePathKernels() {
+    static const PathKernelTable* active = &detectPathKernels();
+    return active;
+}
+
+inline void setPathKernels(const PathKernelTable& table) { activePathKernels() = &table; }
+
+inline double soaPathLength(const PathSoA& p) {
+    return activePathKernels()->length(p.x(), p.y(), p.z(), p.size());
+}
+
+// length of segment i (waypoint i to i + 1); size() - 1 values
+inline vector<double> soaSegmentLengths(const PathSoA& p) {
+    vector<double> out(p.size() > 1 ? p.size() - 1 : 0);
+    activePathKernels()->segments(p.x(), p.y(), p.z(), p.size(), out.data());
+    return out;
+}
+
+// distance flown on arrival at each waypoint; size() values starting at 0
+inline vector<double> soaCumulativeLength(const PathSoA& p) {
+    vector<double> out(p.size());
+    activePathKernels()->cumulative(p.x(), p.y(), p.z(), p.size(), out.data());
+    return out;
+}
+
+inline PathBounds soaBounds(const PathSoA& p) {
+    double lo[3], hi[3];
+    activePathKernels()->bounds(p.x(), p.y(), p.z(), p.size(), lo, hi);
+    PathBounds b;
+    if (!p.empty()) {
+        b.lo = Vector3D(lo[0], lo[1], lo[2]);
+        b.hi = Vector3D(hi[0], hi[1], hi[2]);
+    }
+    return b;
+}
+
+// Charge left on arrival at each waypoint for a battery that starts at
+// startCharge and burns ratePerUnit per distance unit, as Drone::move does.
+// Returns the first waypoint where the charge is at or below reserve
+// (size() if it never is).
+inline size_t soaBatteryAlongPath(const PathSoA& p, double startCharge, double ratePerUnit, double reserve,
+                                  vector<double>& remaining) {
+    remaining.resize(p.size());
+    return activePathKernels()->battery(p.x(), p.y(), p.z(), p.size(), startCharge, ratePerUnit, reserve,
+                                        remaining.data());
+}
+
+#endif
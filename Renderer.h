@@ -0,0 +1,304 @@
+// Renderer.h - Console output backends (Windows console, ANSI terminal, headless)
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#ifdef _WIN32
+#include <windows.h>
+#include <conio.h>
+#else
+#include <termios.h>
+#include <unistd.h>
+#include <thread>
+#include <chrono>
+#endif
+#include <iostream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+using namespace std;
+
+// Color constants (Windows console attribute values; other backends map them)
+enum ConsoleColor {
+    GRAY = 8,
+    BLUE = 9,
+    GREEN = 10,
+    CYAN = 11,
+    RED = 12,
+    MAGENTA = 13,
+    YELLOW = 14,
+    WHITE = 15
+};
+
+inline void sleepMs(int ms) {
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    this_thread::sleep_for(chrono::milliseconds(ms));
+#endif
+}
+
+// block until a key is pressed (no echo, no Enter needed)
+inline int waitForKey() {
+#ifdef _WIN32
+    return _getch();
+#else
+    termios oldt, newt;
+    if (tcgetattr(STDIN_FILENO, &oldt) != 0) return getchar();   // not a terminal
+    newt = oldt;
+    newt.c_lflag &= ~(ICANON | ECHO);
+    tcsetattr(STDIN_FILENO, TCSANOW, &newt);
+    int c = getchar();
+    tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
+    return c;
+#endif
+}
+
+inline void clearConsole() {
+#ifdef _WIN32
+    system("cls");
+#else
+    cout << "\033[2J\033[H" << flush;
+#endif
+}
+
+// Abstract output device used by ConsoleSimulator
+class IRenderer {
+public:
+    virtual void clearScreen() = 0;
+    virtual void setCursor(int x, int y) = 0;
+    virtual void setColor(int color) = 0;
+    virtual void write(const string& text) = 0;
+    virtual void flush() = 0;
+    virtual void pause(int ms) = 0;         // delay between animation frames
+    virtual bool isInteractive() const = 0; // false: skip drawing and delays entirely
+    virtual ~IRenderer() {}
+};
+
+// one character cell of a FrameBuffer
+struct ConsoleCell {
+    char ch;
+    unsigned char color;
+
+    bool operator==(const ConsoleCell& other) const { return ch == other.ch && color == other.color; }
+    bool operator!=(const ConsoleCell& other) const { return !(*this == other); }
+};
+
+// Off-screen character grid. present() compares it with what the screen
+// already shows and sends only the changed cells: one cursor move per run of
+// changes and one color switch per run of equal colors.
+class FrameBuffer {
+private:
+    enum { kMaxGap = 4 };   // unchanged cells bridged inside a run (cheaper than a cursor move)
+    int width, height;
+    vector<ConsoleCell> cells;  // frame being composed
+    vector<ConsoleCell> shown;  // what the screen holds after the last present()
+
+public:
+    FrameBuffer(int w = 0, int h = 0) : width(0), height(0) { resize(w, h); }
+
+    void resize(int w, int h) {
+        width = max(0, w);
+        height = max(0, h);
+        ConsoleCell blank = {' ', (unsigned char)WHITE};
+        cells.assign((size_t)width * height, blank);
+        shown.assign((size_t)width * height, blank);
+    }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    void clear() {
+        ConsoleCell blank = {' ', (unsigned char)WHITE};
+        fill(cells.begin(), cells.end(), blank);
+    }
+
+    // start a frame from a pre-composed layer of the same size
+    void copyFrom(const FrameBuffer& layer) { cells = layer.cells; }
+
+    // the screen was just cleared; next present() draws every non-blank cell
+    void markScreenCleared() {
+        ConsoleCell blank = {' ', (unsigned char)WHITE};
+        fill(shown.begin(), shown.end(), blank);
+    }
+
+    ConsoleCell at(int x, int y) const { return cells[(size_t)y * width + x]; }
+
+    void put(int x, int y, char ch, int color) {
+        if (x < 0 || y < 0 || x >= width || y >= height) return;
+        ConsoleCell& c = cells[(size_t)y * width + x];
+        c.ch = ch;
+        c.color = (unsigned char)color;
+    }
+
+    // returns the column after the text
+    int text(int x, int y, const string& str, int color) {
+        for (char ch : str) put(x++, y, ch, color);
+        return x;
+    }
+
+    // send the difference to the renderer; returns the number of changed cells
+    size_t present(IRenderer& out) {
+        size_t changed = 0;
+        int activeColor = -1;
+        string run;
+        for (int y = 0; y < height; y++) {
+            const ConsoleCell* row = &cells[(size_t)y * width];
+            const ConsoleCell* prev = &shown[(size_t)y * width];
+            int x = 0;
+            while (x < width) {
+                if (row[x] == prev[x]) {
+                    x++;
+                    continue;
+                }
+                // extend the run until kMaxGap unchanged cells in a row
+                int end = x + 1, lastChanged = x;
+                while (end < width && end - lastChanged <= kMaxGap) {
+                    if (row[end] != prev[end]) lastChanged = end;
+                    end++;
+                }
+                end = lastChanged + 1;
+
+                out.setCursor(x, y);
+                for (int i = x; i < end; i++) {
+                    if (row[i].color != activeColor) {
+                        if (!run.empty()) {
+                            out.write(run);
+                            run.clear();
+                        }
+                        activeColor = row[i].color;
+                        out.setColor(activeColor);
+                    }
+                    run += row[i].ch;
+                    if (row[i] != prev[i]) changed++;
+                }
+                out.write(run);
+                run.clear();
+                x = end;
+            }
+        }
+        shown = cells;
+        return changed;
+    }
+};
+
+// Draws nothing and never sleeps, so simulations run as fast as the CPU allows
+class HeadlessRenderer : public IRenderer {
+public:
+    void clearScreen() override {}
+    void setCursor(int, int) override {}
+    void setColor(int) override {}
+    void write(const string&) override {}
+    void flush() override {}
+    void pause(int) override {}
+    bool isInteractive() const override { return false; }
+};
+
+// VT100/ANSI escape sequences for Linux and macOS terminals.
+// Output is collected in memory and sent in one write on flush().
+class AnsiRenderer : public IRenderer {
+private:
+    string pending;
+
+    static const char* colorCode(int color) {
+        switch (color) {
+        case GRAY: return "\033[90m";
+        case BLUE: return "\033[94m";
+        case GREEN: return "\033[92m";
+        case CYAN: return "\033[96m";
+        case RED: return "\033[91m";
+        case MAGENTA: return "\033[95m";
+        case YELLOW: return "\033[93m";
+        default: return "\033[97m";
+        }
+    }
+
+public:
+    AnsiRenderer() { pending = "\033[?25l"; }     // hide cursor for smoother animation
+    ~AnsiRenderer() {
+        pending += "\033[0m\033[?25h";
+        flush();
+    }
+
+    void clearScreen() override { pending += "\033[2J\033[H"; }
+    void setCursor(int x, int y) override {
+        pending += "\033[" + to_string(y + 1) + ";" + to_string(x + 1) + "H";
+    }
+    void setColor(int color) override { pending += colorCode(color); }
+    void write(const string& text) override { pending += text; }
+    void flush() override {
+        cout.write(pending.data(), (streamsize)pending.size());
+        cout.flush();
+        pending.clear();
+    }
+    void pause(int ms) override { sleepMs(ms); }
+    bool isInteractive() const override { return true; }
+};
+
+#ifdef _WIN32
+// Native Windows console API
+class WindowsConsoleRenderer : public IRenderer {
+private:
+    HANDLE hConsole;
+
+public:
+    WindowsConsoleRenderer() {
+        hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+
+        // Hide cursor for smoother animation
+        CONSOLE_CURSOR_INFO cursorInfo;
+        GetConsoleCursorInfo(hConsole, &cursorInfo);
+        cursorInfo.bVisible = FALSE;
+        SetConsoleCursorInfo(hConsole, &cursorInfo);
+    }
+
+    ~WindowsConsoleRenderer() {
+        // Restore cursor
+        CONSOLE_CURSOR_INFO cursorInfo;
+        GetConsoleCursorInfo(hConsole, &cursorInfo);
+        cursorInfo.bVisible = TRUE;
+        SetConsoleCursorInfo(hConsole, &cursorInfo);
+    }
+
+    void clearScreen() override {
+        cout.flush();
+        COORD topLeft = {0, 0};
+        CONSOLE_SCREEN_BUFFER_INFO screen;
+        DWORD written;
+
+        GetConsoleScreenBufferInfo(hConsole, &screen);
+        FillConsoleOutputCharacterA(hConsole, ' ', screen.dwSize.X * screen.dwSize.Y, topLeft, &written);
+        FillConsoleOutputAttribute(hConsole, FOREGROUND_GREEN | FOREGROUND_RED | FOREGROUND_BLUE,
+            screen.dwSize.X * screen.dwSize.Y, topLeft, &written);
+        SetConsoleCursorPosition(hConsole, topLeft);
+    }
+
+    void setCursor(int x, int y) override {
+        cout.flush();
+        COORD pos = {(SHORT)x, (SHORT)y};
+        SetConsoleCursorPosition(hConsole, pos);
+    }
+
+    void setColor(int color) override {
+        cout.flush();
+        SetConsoleTextAttribute(hConsole, color);
+    }
+
+    void write(const string& text) override { cout << text; }
+    void flush() override { cout.flush(); }
+    void pause(int ms) override { Sleep(ms); }
+    bool isInteractive() const override { return true; }
+};
+#endif
+
+// the interactive backend for the current platform
+inline unique_ptr<IRenderer> makeConsoleRenderer() {
+#ifdef _WIN32
+    return make_unique<WindowsConsoleRenderer>();
+#else
+    return make_unique<AnsiRenderer>();
+#endif
+}
+
+#endif
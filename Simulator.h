@@ -1,4 +1,4 @@
-// Simulator.h - Windows console simulation with graphics
+// Simulator.h - Console flight simulation over a pluggable renderer
 #ifndef SIMULATOR_H
 #define SIMULATOR_H
 
@@ -6,99 +6,70 @@
 #define _GLIBCXX_HAS_GTHREADS
 #endif
 
-#include <windows.h>
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <string>
 #include <iomanip>
+#include <memory>
+#include <chrono>
+#include <functional>
 #include "Common.h"
 #include "Map.h"
 #include "Drone.h"
+#include "Renderer.h"
 using namespace std;
 
 class ConsoleSimulator {
 private:
-    HANDLE hConsole;
+    unique_ptr<IRenderer> renderer;
     int consoleWidth, consoleHeight;
+
+    // Frames are composed off-screen: the static layer (title, ruler,
+    // obstacles, legend) is rasterized once per map revision and copied in,
+    // then the drone, path and status text are drawn on top and only the
+    // cells that differ from the screen are sent to the renderer.
+    FrameBuffer frame;
+    FrameBuffer staticLayer;
+    const Map3D* staticMap;
+    unsigned long staticRevision;
+    int mapRows;            // rows used by the map view and legend
+    int cursorRow;          // where text continues after the last present
+    size_t lastChangedCells;
     
-    // Color constants using enum
-    enum Colors {
-        GRAY = 8,
-        BLUE = 9,
-        GREEN = 10,
-        CYAN = 11,
-        RED = 12,
-        MAGENTA = 13,
-        YELLOW = 14,
-        WHITE = 15
-    };
-    
-    void setCursor(int x, int y) {
-        COORD pos = {(SHORT)x, (SHORT)y};
-        SetConsoleCursorPosition(hConsole, pos);
-    }
-    
-    void setColor(int color) {
-        SetConsoleTextAttribute(hConsole, color);
-    }
-    
+    void setCursor(int x, int y) { renderer->setCursor(x, y); }
+    void setColor(int color) { renderer->setColor(color); }
     void clearScreen() {
-        COORD topLeft = {0, 0};
-        CONSOLE_SCREEN_BUFFER_INFO screen;
-        DWORD written;
-        
-        GetConsoleScreenBufferInfo(hConsole, &screen);
-        FillConsoleOutputCharacterA(hConsole, ' ', screen.dwSize.X * screen.dwSize.Y, topLeft, &written);
-        FillConsoleOutputAttribute(hConsole, FOREGROUND_GREEN | FOREGROUND_RED | FOREGROUND_BLUE,
-            screen.dwSize.X * screen.dwSize.Y, topLeft, &written);
-        SetConsoleCursorPosition(hConsole, topLeft);
+        renderer->clearScreen();
+        frame.markScreenCleared();
     }
+    void print(const string& text) { renderer->write(text); }
 
-public:
-    ConsoleSimulator() {
-        hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-        consoleWidth = 100;
-        consoleHeight = 40;
+    static int displayWidth(const Map3D& map) { return min(map.getWidth(), 50); }
+    static int displayDepth(const Map3D& map) { return min(map.getDepth(), 25); }
+
+    void buildStaticLayer(const Map3D& map) {
+        int mapW = displayWidth(map);
+        int mapD = displayDepth(map);
+        staticLayer.clear();
         
-        // Hide cursor for smoother animation
-        CONSOLE_CURSOR_INFO cursorInfo;
-        GetConsoleCursorInfo(hConsole, &cursorInfo);
-        cursorInfo.bVisible = FALSE;
-        SetConsoleCursorInfo(hConsole, &cursorInfo);
-    }
-    
-    ~ConsoleSimulator() {
-        // Restore cursor
-        CONSOLE_CURSOR_INFO cursorInfo;
-        GetConsoleCursorInfo(hConsole, &cursorInfo);
-        cursorInfo.bVisible = TRUE;
-        SetConsoleCursorInfo(hConsole, &cursorInfo);
-    }
-    
-    void drawMap(const Map3D& map, const Vector3D& dronePos, 
-                 const Vector3D& start, const Vector3D& dest,
-                 const vector<Vector3D>& path, bool forAnimation = false) {
+        // Title
+        staticLayer.text(0, 0, "=== DRONE FLIGHT SIMULATOR - " + map.getName() + " ===", CYAN);
         
-        if (!forAnimation) {
-            clearScreen();
-        } else {
-            setCursor(0, 0);
+        // Column ruler
+        for (int x = 0; x < mapW; x += 5) {
+            staticLayer.text(3 + x, 3, to_string(x), WHITE);
         }
         
-        // Map dimensions for display
-        int mapW = min(map.getWidth(), 50);
-        int mapD = min(map.getDepth(), 25);
-        
-        // Title
-        setColor(CYAN);
-        cout << "=== DRONE FLIGHT SIMULATOR - " << map.getName() << " ===                    \n";
-        setColor(WHITE);
-        cout << "Map: " << map.getWidth() << "x" << map.getDepth() << "x" << map.getHeight() << " | ";
-        cout << "Drone: " << dronePos << "                    \n\n";
-        
-        // Create 2D view (top-down)
-        vector<vector<char>> display(mapD, vector<char>(mapW, '.'));
-        vector<vector<int>> colors(mapD, vector<int>(mapW, GRAY));
+        // Top-down view: row labels and empty cells
+        for (int y = 0; y < mapD; y++) {
+            ostringstream label;
+            label << setw(2) << y << " ";
+            staticLayer.text(0, 4 + y, label.str(), WHITE);
+            for (int x = 0; x < mapW; x++) {
+                staticLayer.put(3 + x, 4 + y, '.', GRAY);
+            }
+        }
         
         // Mark obstacles
         for (const auto& obs : map.getObstacles()) {
@@ -107,172 +78,237 @@ public:
             int ol = (int)obs.getLength();
             int ow = (int)obs.getWidth();
             
-            for (int x = ox; x < ox + ol && x < mapW; x++) {
-                for (int y = oy; y < oy + ow && y < mapD; y++) {
-                    if (x >= 0 && y >= 0) {
-                        if (obs.getHeight() > 10) {
-                            display[y][x] = '#';
-                            colors[y][x] = RED;
-                        } else if (obs.getHeight() > 5) {
-                            display[y][x] = 'B';
-                            colors[y][x] = YELLOW;
-                        } else {
-                            display[y][x] = 'o';
-                            colors[y][x] = GREEN;
-                        }
-                    }
+            char ch = 'o';
+            int color = GREEN;
+            if (obs.getHeight() > 10) {
+                ch = '#';
+                color = RED;
+            } else if (obs.getHeight() > 5) {
+                ch = 'B';
+                color = YELLOW;
+            }
+            for (int x = max(ox, 0); x < ox + ol && x < mapW; x++) {
+                for (int y = max(oy, 0); y < oy + ow && y < mapD; y++) {
+                    staticLayer.put(3 + x, 4 + y, ch, color);
                 }
             }
         }
         
-        // Mark path
+        // Legend
+        int row = 5 + mapD;
+        int x = staticLayer.text(0, row, "Legend: ", WHITE);
+        const char* symbols = "@SD#Bo*";
+        const int symbolColors[] = {BLUE, GREEN, MAGENTA, RED, YELLOW, GREEN, CYAN};
+        const char* names[] = {"=Drone ", "=Start ", "=Dest ", "=Tall ", "=Building ", "=Low ", "=Path"};
+        for (int i = 0; i < 7; i++) {
+            staticLayer.put(x++, row, symbols[i], symbolColors[i]);
+            x = staticLayer.text(x, row, names[i], WHITE);
+        }
+        
+        mapRows = row + 1;
+        staticMap = &map;
+        staticRevision = map.getRevision();
+    }
+
+    void composeMap(const Map3D& map, const Vector3D& dronePos,
+                    const Vector3D& start, const Vector3D& dest,
+                    const vector<Vector3D>& path) {
+        if (staticMap != &map || staticRevision != map.getRevision()) {
+            buildStaticLayer(map);
+        }
+        frame.copyFrom(staticLayer);
+        
+        int mapW = displayWidth(map);
+        int mapD = displayDepth(map);
+        ostringstream header;
+        header << "Map: " << map.getWidth() << "x" << map.getDepth() << "x" << map.getHeight() << " | ";
+        header << "Drone: " << dronePos;
+        frame.text(0, 1, header.str(), WHITE);
+        
+        // Mark path (only over empty cells)
         for (const auto& p : path) {
             int px = (int)p.getX();
             int py = (int)p.getY();
-            if (px >= 0 && px < mapW && py >= 0 && py < mapD) {
-                if (display[py][px] == '.') {
-                    display[py][px] = '*';
-                    colors[py][px] = CYAN;
-                }
+            if (px >= 0 && px < mapW && py >= 0 && py < mapD && frame.at(3 + px, 4 + py).ch == '.') {
+                frame.put(3 + px, 4 + py, '*', CYAN);
             }
         }
         
         // Mark start and destination
         int sx = (int)start.getX(), sy = (int)start.getY();
         int dx = (int)dest.getX(), dy = (int)dest.getY();
-        if (sx >= 0 && sx < mapW && sy >= 0 && sy < mapD) {
-            display[sy][sx] = 'S';
-            colors[sy][sx] = GREEN;
-        }
-        if (dx >= 0 && dx < mapW && dy >= 0 && dy < mapD) {
-            display[dy][dx] = 'D';
-            colors[dy][dx] = MAGENTA;
-        }
+        if (sx >= 0 && sx < mapW && sy >= 0 && sy < mapD) frame.put(3 + sx, 4 + sy, 'S', GREEN);
+        if (dx >= 0 && dx < mapW && dy >= 0 && dy < mapD) frame.put(3 + dx, 4 + dy, 'D', MAGENTA);
         
         // Mark drone position (overwrites path for visibility)
         int droneX = (int)dronePos.getX();
         int droneY = (int)dronePos.getY();
         if (droneX >= 0 && droneX < mapW && droneY >= 0 && droneY < mapD) {
-            display[droneY][droneX] = '@';
-            colors[droneY][droneX] = BLUE;
+            frame.put(3 + droneX, 4 + droneY, '@', BLUE);
         }
+        cursorRow = mapRows;
+    }
+
+    void composeStatus(const Drone& drone, int currentWaypoint, int totalWaypoints) {
+        int row = mapRows + 1;
+        frame.text(0, row++, "--- Flight Status ---", CYAN);
         
-        // Draw the map
-        cout << "   ";
-        setColor(WHITE);
-        for (int x = 0; x < mapW; x += 5) {
-            cout << x;
-            int digits = (x == 0) ? 1 : (int)log10(x) + 1;
-            cout << string(5 - digits, ' ');
-        }
-        cout << "\n";
+        ostringstream line;
+        line << "Position: " << drone.getPosition();
+        frame.text(0, row++, line.str(), WHITE);
         
-        for (int y = 0; y < mapD; y++) {
-            setColor(WHITE);
-            cout << setw(2) << y << " ";
-            for (int x = 0; x < mapW; x++) {
-                setColor(colors[y][x]);
-                cout << display[y][x];
-            }
-            cout << "  \n";  // Extra spaces to clear any residual characters
-        }
+        line.str("");
+        line << "Waypoint: " << currentWaypoint << "/" << totalWaypoints;
+        frame.text(0, row++, line.str(), WHITE);
         
-        // Legend
+        double batt = drone.getBattery().getPercentage();
+        int battColor = batt > 50 ? GREEN : (batt > 20 ? YELLOW : RED);
+        line.str("");
+        line << fixed << setprecision(1) << batt << "%";
+        int x = frame.text(0, row, "Battery: ", WHITE);
+        frame.text(x, row++, line.str(), battColor);
+        
+        line.str("");
+        line << "Distance Traveled: " << fixed << setprecision(2) << drone.getTotalDistance() << " units";
+        frame.text(0, row++, line.str(), WHITE);
+        
+        line.str("");
+        line << "Altitude: " << fixed << setprecision(1) << drone.getPosition().getZ() << " units";
+        frame.text(0, row++, line.str(), WHITE);
+        cursorRow = row;
+    }
+
+    // send the composed frame, leave the cursor below it
+    void present() {
+        lastChangedCells = frame.present(*renderer);
+        setCursor(0, cursorRow);
         setColor(WHITE);
-        cout << "\nLegend: ";
-        setColor(BLUE); cout << "@";
-        setColor(WHITE); cout << "=Drone ";
-        setColor(GREEN); cout << "S";
-        setColor(WHITE); cout << "=Start ";
-        setColor(MAGENTA); cout << "D";
-        setColor(WHITE); cout << "=Dest ";
-        setColor(RED); cout << "#";
-        setColor(WHITE); cout << "=Tall ";
-        setColor(YELLOW); cout << "B";
-        setColor(WHITE); cout << "=Building ";
-        setColor(GREEN); cout << "o";
-        setColor(WHITE); cout << "=Low ";
-        setColor(CYAN); cout << "*";
-        setColor(WHITE); cout << "=Path      \n";
+        renderer->flush();
+    }
+
+public:
+    ConsoleSimulator() : ConsoleSimulator(makeConsoleRenderer()) {}
+
+    explicit ConsoleSimulator(unique_ptr<IRenderer> backend)
+        : renderer(move(backend)), staticMap(nullptr), staticRevision(0),
+          mapRows(0), cursorRow(0), lastChangedCells(0) {
+        consoleWidth = 100;
+        consoleHeight = 40;
+        frame.resize(consoleWidth, consoleHeight);
+        staticLayer.resize(consoleWidth, consoleHeight);
+    }
+
+    // swap the output backend (e.g. HeadlessRenderer for batch runs)
+    void setRenderer(unique_ptr<IRenderer> backend) { renderer = move(backend); }
+    bool isHeadless() const { return !renderer->isInteractive(); }
+
+    // cells sent to the console by the last frame
+    size_t getLastChangedCells() const { return lastChangedCells; }
+    
+    void drawMap(const Map3D& map, const Vector3D& dronePos, 
+                 const Vector3D& start, const Vector3D& dest,
+                 const vector<Vector3D>& path, bool forAnimation = false) {
+        // a fresh (non-animation) draw starts from a cleared screen
+        if (!forAnimation) {
+            clearScreen();
+        }
+        composeMap(map, dronePos, start, dest, path);
+        present();
     }
     
     void drawFlightStatus(const Drone& drone, int currentWaypoint, int totalWaypoints) {
-        setColor(CYAN);
-        cout << "\n--- Flight Status ---                              \n";
-        setColor(WHITE);
-        cout << "Position: " << drone.getPosition() << "                    \n";
-        cout << "Waypoint: " << currentWaypoint << "/" << totalWaypoints << "                    \n";
-        cout << "Battery: ";
-        
-        double batt = drone.getBattery().getPercentage();
-        if (batt > 50) setColor(GREEN);
-        else if (batt > 20) setColor(YELLOW);
-        else setColor(RED);
-        cout << fixed << setprecision(1) << batt << "%                    \n";
-        
-        setColor(WHITE);
-        cout << "Distance Traveled: " << fixed << setprecision(2) 
-                  << drone.getTotalDistance() << " units                    \n";
-        cout << "Altitude: " << fixed << setprecision(1) 
-                  << drone.getPosition().getZ() << " units                    \n";
+        composeStatus(drone, currentWaypoint, totalWaypoints);
+        present();
     }
     
+    // Called after the drone reaches path[reached]. It may replace the route
+    // with a new one starting at the drone's position and return true, e.g. to
+    // replan around an obstacle that appeared mid-flight.
+    typedef function<bool(size_t reached, vector<Vector3D>& path)> WaypointHook;
+
     void simulateFlight(Drone& drone, const Map3D& map, 
-                        const vector<Vector3D>& path,
+                        const vector<Vector3D>& plannedPath,
                         const Vector3D& start, const Vector3D& dest,
-                        int delayMs = 200) {
+                        int delayMs = 200, const WaypointHook& onWaypoint = WaypointHook()) {
         
+        vector<Vector3D> path = plannedPath;
         if (path.empty()) {
-            cout << "No path to simulate!\n";
+            print("No path to simulate!\n");
             return;
         }
         
         drone.setPosition(start);
         drone.takeOff();
+
+        // headless: same flight and battery model, no frames and no delays
+        bool rendering = renderer->isInteractive();
         
         // Initial draw
-        clearScreen();
+        if (rendering) clearScreen();
+
+        typedef chrono::steady_clock Clock;
+        Clock::time_point flightStart = Clock::now();
+        double renderMs = 0;
+        int frames = 0;
         
         for (size_t i = 0; i < path.size(); i++) {
             // Move drone to next waypoint
             drone.move(path[i]);
             
-            // Redraw map with updated drone position
-            drawMap(map, drone.getPosition(), start, dest, path, true);
-            
-            // Draw status below map
-            drawFlightStatus(drone, (int)(i + 1), (int)path.size());
-            
-            // Flush output to ensure immediate display
-            cout.flush();
-            
-            // Wait before next frame
-            Sleep(delayMs);
+            if (rendering) {
+                // One frame: map, status and counters, written in a single present
+                Clock::time_point t0 = Clock::now();
+                composeMap(map, drone.getPosition(), start, dest, path);
+                composeStatus(drone, (int)(i + 1), (int)path.size());
+                
+                frames++;
+                double elapsed = chrono::duration<double>(Clock::now() - flightStart).count();
+                ostringstream counters;
+                counters << "Frame " << frames << " | " << fixed << setprecision(1)
+                         << (elapsed > 0 ? frames / elapsed : 0.0) << " fps | render "
+                         << setprecision(2) << (frames > 1 ? renderMs / (frames - 1) : 0.0)
+                         << " ms | " << lastChangedCells << " cells changed";
+                frame.text(0, cursorRow++, counters.str(), GRAY);
+                present();
+                renderMs += chrono::duration<double, milli>(Clock::now() - t0).count();
+                
+                // Wait before next frame
+                renderer->pause(delayMs);
+            }
             
             // Check for critical battery
             if (drone.getBattery().getPercentage() < 5) {
                 setColor(RED);
-                cout << "\n!!! CRITICAL BATTERY - EMERGENCY LANDING !!!                    \n";
+                print("\n!!! CRITICAL BATTERY - EMERGENCY LANDING !!!                    \n");
                 setColor(WHITE);
                 break;
             }
+            
+            // new route from here: its first waypoint is the current position
+            if (onWaypoint && i + 1 < path.size() && onWaypoint(i, path) && !path.empty()) {
+                i = 0;
+            }
         }
         
         drone.land();
         setColor(GREEN);
-        cout << "\n=== FLIGHT COMPLETE ===                              \n";
+        print("\n=== FLIGHT COMPLETE ===                              \n");
         setColor(WHITE);
+        renderer->flush();
     }
     
     void drawProgressBar(double progress, int width = 40) {
         int filled = (int)(progress * width);
-        cout << "[";
+        ostringstream bar;
+        bar << "[";
         for (int i = 0; i < width; i++) {
-            if (i < filled) cout << "=";
-            else if (i == filled) cout << ">";
-            else cout << " ";
+            if (i < filled) bar << "=";
+            else if (i == filled) bar << ">";
+            else bar << " ";
         }
-        cout << "] " << fixed << setprecision(1) << (progress * 100) << "%";
+        bar << "] " << fixed << setprecision(1) << (progress * 100) << "%";
+        print(bar.str());
+        renderer->flush();
     }
 };
 
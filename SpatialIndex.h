@@ -0,0 +1,104 @@
+// SpatialIndex.h - Uniform bucket grid over obstacles for fast map queries
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include "Common.h"
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+// Uniform grid of XY columns; each bucket lists the obstacles whose footprint
+// (inflated by the indexed margin) overlaps it. City obstacles stand on the
+// ground and span most of the height, so columns filter as well as 3D cells
+// while keeping the bucket count small on large maps.
+class ObstacleGrid {
+private:
+    double cellSize;
+    double margin;          // inflation applied at insert; queries up to this margin are exact
+    int cols, rows;
+    vector<vector<int>> buckets;
+
+    int clampCol(double x) const { return max(0, min(cols - 1, (int)floor(x / cellSize))); }
+    int clampRow(double y) const { return max(0, min(rows - 1, (int)floor(y / cellSize))); }
+
+public:
+    ObstacleGrid(double size = 4.0, double indexedMargin = 1.0)
+        : cellSize(size), margin(indexedMargin), cols(0), rows(0) {}
+
+    void reset(int width, int depth) {
+        cols = max(1, (int)ceil(width / cellSize));
+        rows = max(1, (int)ceil(depth / cellSize));
+        buckets.assign((size_t)cols * rows, vector<int>());
+    }
+
+    void insert(const Obstacle& obs, int obstacleIdx) {
+        if (buckets.empty()) return;
+        Vector3D p = obs.getPosition();
+        int c0 = clampCol(p.getX() - margin);
+        int c1 = clampCol(p.getX() + obs.getLength() + margin);
+        int r0 = clampRow(p.getY() - margin);
+        int r1 = clampRow(p.getY() + obs.getWidth() + margin);
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                buckets[(size_t)r * cols + c].push_back(obstacleIdx);
+            }
+        }
+    }
+
+    void build(const vector<Obstacle>& obstacles, int width, int depth) {
+        reset(width, depth);
+        for (size_t i = 0; i < obstacles.size(); i++) {
+            insert(obstacles[i], (int)i);
+        }
+    }
+
+    // obstacles that may contain the point (for any query margin <= getMargin())
+    const vector<int>& candidates(const Vector3D& p) const {
+        return buckets[(size_t)clampRow(p.getY()) * cols + clampCol(p.getX())];
+    }
+
+    // Visit the buckets crossed by the XY projection of segment a-b (2D DDA walk).
+    // Stops early and returns false as soon as visit() returns false.
+    template <typename Visit>
+    bool walkSegment(const Vector3D& a, const Vector3D& b, Visit visit) const {
+        if (buckets.empty()) return true;
+        double x0 = a.getX() / cellSize, y0 = a.getY() / cellSize;
+        double dx = b.getX() / cellSize - x0, dy = b.getY() / cellSize - y0;
+        int c = clampCol(a.getX()), r = clampRow(a.getY());
+        int cEnd = clampCol(b.getX()), rEnd = clampRow(b.getY());
+        int stepC = dx > 0 ? 1 : -1, stepR = dy > 0 ? 1 : -1;
+        const double inf = numeric_limits<double>::infinity();
+        double tMaxX = dx != 0 ? ((stepC > 0 ? c + 1 : c) - x0) / dx : inf;
+        double tMaxY = dy != 0 ? ((stepR > 0 ? r + 1 : r) - y0) / dy : inf;
+        double tDeltaX = dx != 0 ? fabs(1.0 / dx) : inf;
+        double tDeltaY = dy != 0 ? fabs(1.0 / dy) : inf;
+
+        int guard = cols + rows + 2;
+        while (guard-- > 0) {
+            if (!visit(buckets[(size_t)r * cols + c])) return false;
+            if (c == cEnd && r == rEnd) break;
+            if (tMaxX < tMaxY) {
+                c += stepC;
+                tMaxX += tDeltaX;
+            } else {
+                r += stepR;
+                tMaxY += tDeltaY;
+            }
+            if (c < 0 || c >= cols || r < 0 || r >= rows) break;
+        }
+        return true;
+    }
+
+    bool isBuilt() const { return !buckets.empty(); }
+    double getMargin() const { return margin; }
+    double getCellSize() const { return cellSize; }
+    int getBucketCount() const { return cols * rows; }
+
+    size_t getEntryCount() const {
+        size_t total = 0;
+        for (const auto& b : buckets) total += b.size();
+        return total;
+    }
+};
+
+#endif
@@ -0,0 +1,162 @@
+// ThetaStarFinder.h - Any-angle Lazy Theta* on the A* lattice
+#ifndef THETASTARFINDER_H
+#define THETASTARFINDER_H
+
+#include "Common.h"
+#include "Map.h"
+#include "PathFinder.h"
+#include "GridPathFinder.h"
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <limits>
+using namespace std;
+
+// Lazy Theta*: A* on the same lattice as GridPathFinder, except that a
+// neighbour inherits its parent's parent whenever that is shorter, so the
+// path bends only at obstacle corners and needs no smoothing pass. The
+// line-of-sight test for that shortcut is deferred until the node is
+// expanded (at most one isSegmentClear per expansion, none for plain
+// lattice edges); when it fails the node falls back to its best closed
+// lattice neighbour, as A* would have linked it.
+class ThetaStarFinder : public IPathFinder {
+private:
+    struct ThetaOpenEntry {
+        double f;
+        int cell;
+        bool operator>(const ThetaOpenEntry& other) const { return f > other.f; }
+    };
+
+    const Map3D* map;
+    double gridStep;
+    int maxIterations;
+
+    GridLattice lattice;
+    const VoxelGrid* occupancy;     // non-null when the baked bitmap shares this query's lattice
+    LatticeSearch search;               // workspace kept across queries
+    vector<ThetaOpenEntry> openSet;     // binary heap with lazy duplicates
+    SearchStats lastStats;
+
+    bool lineOfSight(const Vector3D& from, const Vector3D& to) {
+        lastStats.segmentChecks++;
+        return map->isSegmentClear(from, to);
+    }
+
+    // Lazy Theta* SetVertex: confirm the assumed shortcut to parent(cell), or
+    // repair g and parent from the closed lattice neighbours
+    void confirmParent(int cell, int ci, int cj, int ck) {
+        int p = search.parent[cell];
+        if (p < 0) return;
+        int pi, pj, pk;
+        lattice.coords(p, pi, pj, pk);
+        // lattice edges are taken as is, like A* does
+        if (abs(pi - ci) <= 1 && abs(pj - cj) <= 1 && abs(pk - ck) <= 1) return;
+        if (lineOfSight(lattice.position(pi, pj, pk), lattice.position(ci, cj, ck))) return;
+        double best = numeric_limits<double>::infinity();
+        int bestFrom = -1;
+        for (const NeighborOffset& o : kNeighborOffsets) {
+            int ni = ci + o.dx, nj = cj + o.dy, nk = ck + o.dz;
+            if (!lattice.inBounds(ni, nj, nk)) continue;
+            int n = lattice.index(ni, nj, nk);
+            if (!search.isClosed(n)) continue;
+            double g = search.gScore[n] + o.cost * gridStep;
+            if (g < best) {
+                best = g;
+                bestFrom = n;
+            }
+        }
+        search.gScore[cell] = best;
+        search.parent[cell] = bestFrom;
+    }
+
+public:
+    ThetaStarFinder(const Map3D* m, double step = 1.0)
+        : map(m), gridStep(step), maxIterations(10000), occupancy(nullptr) {}
+
+    void setMaxIterations(int n) { maxIterations = n; }
+    const SearchStats& getLastStats() const { return lastStats; }
+
+    vector<Vector3D> findPath(const Vector3D& start, const Vector3D& end) override {
+        vector<Vector3D> path;
+        lastStats.reset();
+
+        // Quick check for direct path
+        if (map->isSegmentClear(start, end)) {
+            path.push_back(start);
+            path.push_back(end);
+            return path;
+        }
+
+        lattice = GridLattice(*map, start, gridStep);
+        int startCell = lattice.cellOf(start);
+        if (startCell < 0) return safeAltitudePath(map, start, end);
+        search.reset((size_t)lattice.cellCount());
+        openSet.clear();
+
+        occupancy = lattice.matchingOccupancy(*map);
+
+        search.touch(startCell, 0, -1);
+        openSet.push_back({start.distanceTo(end), startCell});
+        lastStats.notePush(openSet.size());
+
+        int iterations = 0;
+        while (!openSet.empty() && iterations < maxIterations) {
+            iterations++;
+            pop_heap(openSet.begin(), openSet.end(), greater<ThetaOpenEntry>());
+            ThetaOpenEntry current = openSet.back();
+            openSet.pop_back();
+
+            if (search.isClosed(current.cell)) {
+                lastStats.stalePops++;
+                continue;
+            }
+            int ci, cj, ck;
+            lattice.coords(current.cell, ci, cj, ck);
+            confirmParent(current.cell, ci, cj, ck);
+            search.setClosed(current.cell);
+            lastStats.expansions++;
+            Vector3D currentPos = lattice.position(ci, cj, ck);
+            double currentG = search.gScore[current.cell];
+
+            // Check if reached destination
+            if (currentPos.distanceTo(end) < gridStep * 1.5) {
+                lastStats.pathCost = currentG + currentPos.distanceTo(end);
+                for (int idx = current.cell; idx != -1; idx = search.parent[idx]) {
+                    path.push_back(lattice.position(idx));
+                }
+                reverse(path.begin(), path.end());
+                // the goal is off-lattice; cut the last corner when possible
+                if (path.size() >= 2 && lineOfSight(path[path.size() - 2], end)) path.pop_back();
+                path.push_back(end);
+                return path;
+            }
+
+            // every successor assumes line of sight from the current node's parent
+            int from = search.parent[current.cell] >= 0 ? search.parent[current.cell] : current.cell;
+            Vector3D fromPos = lattice.position(from);
+            double fromG = search.gScore[from];
+            for (const NeighborOffset& o : kNeighborOffsets) {
+                int ni = ci + o.dx, nj = cj + o.dy, nk = ck + o.dz;
+                if (!lattice.inBounds(ni, nj, nk)) continue;
+                int next = lattice.index(ni, nj, nk);
+                if (search.isClosed(next)) continue;
+
+                Vector3D nextPos = lattice.position(ni, nj, nk);
+                if (occupancy ? occupancy->isBlocked(ni, nj, nk) : map->isBlocked(nextPos)) continue;
+
+                double newG = fromG + fromPos.distanceTo(nextPos);
+                if (newG >= search.gScore[next]) continue;
+                search.touch(next, newG, from);
+                openSet.push_back({newG + nextPos.distanceTo(end), next});
+                push_heap(openSet.begin(), openSet.end(), greater<ThetaOpenEntry>());
+                lastStats.notePush(openSet.size());
+            }
+        }
+
+        // fly high above obstacles
+        return safeAltitudePath(map, start, end);
+    }
+};
+
+#endif
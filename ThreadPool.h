@@ -0,0 +1,100 @@
+// ThreadPool.h - Fixed set of worker threads for data-parallel loops
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+using namespace std;
+
+// Workers are started once and reused for every parallelFor call.
+// Each worker has a stable id in [0, size()) so callers can keep per-worker
+// state (search workspaces, partial results) without locking.
+class ThreadPool {
+private:
+    vector<thread> workers;
+    mutex lock;
+    condition_variable wake;
+    condition_variable finished;
+
+    const function<void(size_t, int)>* job;
+    size_t jobCount;
+    atomic<size_t> nextIndex;
+    int active;
+    unsigned long generation;
+    bool stopping;
+
+    void runJob(int worker) {
+        for (size_t i = nextIndex.fetch_add(1); i < jobCount; i = nextIndex.fetch_add(1)) {
+            (*job)(i, worker);
+        }
+    }
+
+    void workerLoop(int worker) {
+        unsigned long seen = 0;
+        while (true) {
+            {
+                unique_lock<mutex> guard(lock);
+                wake.wait(guard, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            runJob(worker);
+            {
+                lock_guard<mutex> guard(lock);
+                if (--active == 0) finished.notify_all();
+            }
+        }
+    }
+
+public:
+    // threads <= 1 runs every loop inline on the calling thread
+    explicit ThreadPool(int threads = (int)thread::hardware_concurrency())
+        : job(nullptr), jobCount(0), nextIndex(0), active(0), generation(0), stopping(false) {
+        if (threads > 1) {
+            for (int i = 0; i < threads; i++) {
+                workers.push_back(thread(&ThreadPool::workerLoop, this, i));
+            }
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return workers.empty() ? 1 : (int)workers.size(); }
+
+    // calls body(index, workerId) for every index in [0, count); returns when all are done
+    void parallelFor(size_t count, const function<void(size_t, int)>& body) {
+        if (count == 0) return;
+        if (workers.empty()) {
+            for (size_t i = 0; i < count; i++) body(i, 0);
+            return;
+        }
+        {
+            lock_guard<mutex> guard(lock);
+            job = &body;
+            jobCount = count;
+            nextIndex = 0;
+            active = (int)workers.size();
+            generation++;
+        }
+        wake.notify_all();
+        unique_lock<mutex> guard(lock);
+        finished.wait(guard, [&] { return active == 0; });
+        job = nullptr;
+    }
+};
+
+#endif
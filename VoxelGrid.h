@@ -0,0 +1,123 @@
+// VoxelGrid.h - Packed 3D occupancy bitmap baked from map obstacles
+#ifndef VOXELGRID_H
+#define VOXELGRID_H
+
+#include "Common.h"
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+using namespace std;
+
+// One bit per lattice sample point (origin + (i,j,k) * resolution).
+// A bit is set when that exact point lies inside an obstacle inflated by the
+// baked margin, so for planners walking the same lattice a bit test gives the
+// same answer as Map3D::isBlocked with that margin.
+class VoxelGrid {
+private:
+    double originX, originY, originZ;
+    double resolution;
+    double margin;
+    int nx, ny, nz;
+    vector<uint64_t> bits;
+
+    inline size_t bitIndex(int i, int j, int k) const {
+        return ((size_t)k * ny + j) * nx + i;
+    }
+
+    void setBit(int i, int j, int k) {
+        size_t b = bitIndex(i, j, k);
+        bits[b >> 6] |= (1ULL << (b & 63));
+    }
+
+    // lattice index range covering [lo, hi] on one axis
+    static void axisRange(double lo, double hi, double origin, double res, int n, int& first, int& last) {
+        first = max(0, (int)ceil((lo - origin) / res - 1e-9));
+        last = min(n - 1, (int)floor((hi - origin) / res + 1e-9));
+    }
+
+public:
+    VoxelGrid() : originX(0), originY(0), originZ(0), resolution(1.0), margin(0.5), nx(0), ny(0), nz(0) {}
+
+    // size the bitmap over the map bounds; the lattice passes through 'anchor'
+    void reset(int width, int depth, int height, double res, double inflate, const Vector3D& anchor) {
+        resolution = res;
+        margin = inflate;
+        originX = anchor.getX() - floor(anchor.getX() / res) * res;
+        originY = anchor.getY() - floor(anchor.getY() / res) * res;
+        originZ = anchor.getZ() - floor(anchor.getZ() / res) * res;
+        nx = max(0, (int)ceil((width - originX) / res));
+        ny = max(0, (int)ceil((depth - originY) / res));
+        nz = max(0, (int)ceil((height - originZ) / res));
+        bits.assign(((size_t)nx * ny * nz + 63) / 64, 0);
+    }
+
+    // mark the voxels covered by one obstacle; only its inflated box is visited
+    void rasterize(const Obstacle& obs) {
+        if (bits.empty()) return;
+        Vector3D p = obs.getPosition();
+        int i0, i1, j0, j1, k0, k1;
+        axisRange(p.getX() - margin, p.getX() + obs.getLength() + margin, originX, resolution, nx, i0, i1);
+        axisRange(p.getY() - margin, p.getY() + obs.getWidth() + margin, originY, resolution, ny, j0, j1);
+        axisRange(p.getZ() - margin, p.getZ() + obs.getHeight() + margin, originZ, resolution, nz, k0, k1);
+        for (int k = k0; k <= k1; k++) {
+            for (int j = j0; j <= j1; j++) {
+                for (int i = i0; i <= i1; i++) {
+                    // exact test at the sample point keeps parity with containsPoint
+                    if (obs.containsPoint(samplePoint(i, j, k), margin)) setBit(i, j, k);
+                }
+            }
+        }
+    }
+
+    void bake(const vector<Obstacle>& obstacles) {
+        fill(bits.begin(), bits.end(), 0);
+        for (const auto& obs : obstacles) rasterize(obs);
+    }
+
+    inline bool inBounds(int i, int j, int k) const {
+        return i >= 0 && i < nx && j >= 0 && j < ny && k >= 0 && k < nz;
+    }
+
+    // occupied or outside the map
+    inline bool isBlocked(int i, int j, int k) const {
+        if (!inBounds(i, j, k)) return true;
+        size_t b = bitIndex(i, j, k);
+        return (bits[b >> 6] >> (b & 63)) & 1ULL;
+    }
+
+    Vector3D samplePoint(int i, int j, int k) const {
+        return Vector3D(originX + i * resolution, originY + j * resolution, originZ + k * resolution);
+    }
+
+    // nearest sample; returns false if p is not on the lattice
+    bool latticeCoords(const Vector3D& p, int& i, int& j, int& k) const {
+        i = (int)floor((p.getX() - originX) / resolution + 0.5);
+        j = (int)floor((p.getY() - originY) / resolution + 0.5);
+        k = (int)floor((p.getZ() - originZ) / resolution + 0.5);
+        return samplePoint(i, j, k).distanceTo(p) < 1e-6;
+    }
+
+    // true if a planner with this step and margin can use bit tests for this point's lattice
+    bool matches(const Vector3D& anchor, double step, double queryMargin) const {
+        int i, j, k;
+        return !bits.empty() && fabs(step - resolution) < 1e-9 &&
+               fabs(queryMargin - margin) < 1e-9 && latticeCoords(anchor, i, j, k);
+    }
+
+    bool isBaked() const { return !bits.empty(); }
+    Vector3D getOrigin() const { return Vector3D(originX, originY, originZ); }
+    double getResolution() const { return resolution; }
+    double getMargin() const { return margin; }
+    int getSizeX() const { return nx; }
+    int getSizeY() const { return ny; }
+    int getSizeZ() const { return nz; }
+    size_t getMemoryBytes() const { return bits.size() * sizeof(uint64_t); }
+
+    // footprint of a bitmap before allocating it
+    static size_t estimateBytes(int width, int depth, int height, double res) {
+        size_t voxels = (size_t)ceil(width / res) * (size_t)ceil(depth / res) * (size_t)ceil(height / res);
+        return (voxels + 63) / 64 * sizeof(uint64_t);
+    }
+};
+
+#endif
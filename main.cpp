@@ -1,19 +1,27 @@
 // main.cpp - Drone Flight Path Planner Main Application
 //g++ -std=c++14 -o DronePlanner.exe main.cpp -static
+//g++ -std=c++14 -O2 -pthread -o DronePlanner main.cpp      (Linux/macOS)
 #include <iostream>
 #include <iomanip>
 #include <string>
 #include <memory>
 #include <limits>
-#include <conio.h>
+#include <cstring>
+#include <cstdlib>
 
 #include "Common.h"
 #include "Battery.h"
 #include "Drone.h"
 #include "Map.h"
 #include "PathFinder.h"
+#include "GridPathFinder.h"
+#include "PathSoA.h"
 #include "Logger.h"
+#include "MissionAnalytics.h"
 #include "Simulator.h"
+#include "FleetSimulator.h"
+#include "Renderer.h"
+#include "Benchmark.h"
 using namespace std;
 
 // Template function for safe input
@@ -52,7 +60,8 @@ private:
     int activeDroneIdx;
 
 public:
-    FlightPlanner() : activeDroneIdx(0), pathFinder(nullptr)
+    FlightPlanner(unique_ptr<IRenderer> renderer = makeConsoleRenderer())
+        : simulator(move(renderer)), activeDroneIdx(0), pathFinder(nullptr)
     {
         // Initialize map
         map = Map3D(50, 25, 20, "Metro City");
@@ -90,6 +99,8 @@ public:
         cout << "  8. Mission Summary & Statistics\n";
         cout << "  9. Compare Drone Efficiency\n";
         cout << "  10. Clear Mission Logs\n";
+        cout << "  11. Performance Benchmarks\n";
+        cout << "  12. Mission Analytics (by drone / route / day)\n";
         cout << "  0. Exit\n";
         cout << "\n";
         printSeparator('-', 50);
@@ -117,7 +128,7 @@ public:
         }
 
         cout << "\nPress any key to continue...";
-        _getch();
+        waitForKey();
     }
 
     void selectDrone()
@@ -201,6 +212,13 @@ public:
             cout << "\nWARNING: Insufficient battery for this mission!\n";
             cout << "Current: " << drone->getBattery().getPercentage() << "%\n";
             cout << "Required: ~" << (pathDist * drone->getBattery().getConsumptionRate()) << "%\n";
+            const Battery &battery = drone->getBattery();
+            vector<double> charge;
+            size_t lowAt = soaBatteryAlongPath(PathSoA(path), battery.getCharge(), battery.getConsumptionRate(),
+                                               battery.getCapacity() * 0.1, charge);
+            if (lowAt < path.size())
+                cout << "Reserve reached at waypoint " << lowAt << " of " << path.size() - 1
+                     << " " << path[lowAt] << "\n";
             cout << "Continue anyway? (y/n): ";
             char c;
             cin >> c;
@@ -249,7 +267,7 @@ public:
 
         cout << "\nResults saved to mission log.\n";
         cout << "Press any key to continue...";
-        _getch();
+        waitForKey();
     }
 
     void viewDroneStatus()
@@ -270,7 +288,7 @@ public:
         }
 
         cout << "Press any key to continue...";
-        _getch();
+        waitForKey();
     }
 
     void rechargeBattery()
@@ -281,13 +299,13 @@ public:
         {
             cout << "\r";
             simulator.drawProgressBar(i / 100.0, 40);
-            Sleep(50);
+            sleepMs(50);
         }
 
         drones[activeDroneIdx]->getBattery().recharge();
         cout << "\nBattery fully charged to 100%!\n";
         cout << "Press any key to continue...";
-        _getch();
+        waitForKey();
     }
 
     void viewMissionLogs()
@@ -324,21 +342,86 @@ public:
         }
 
         cout << "\nPress any key to continue...";
-        _getch();
+        waitForKey();
     }
 
     void showSummary()
     {
         logger.printSummary();
         cout << "Press any key to continue...";
-        _getch();
+        waitForKey();
     }
 
     void compareEfficiency()
     {
         logger.compareEfficiency();
         cout << "Press any key to continue...";
-        _getch();
+        waitForKey();
+    }
+
+    void missionAnalytics()
+    {
+        cout << "\n--- Mission Analytics ---\n";
+        cout << "  1. By drone\n";
+        cout << "  2. By route (busiest 15)\n";
+        cout << "  3. By day\n";
+        cout << "  0. Back\n";
+        int choice = getInput<int>("Group by: ", 0, 3);
+        if (choice == 0)
+            return;
+
+        ColumnarLogReader reader;
+        if (!logger.openReader(reader) || reader.size() == 0)
+        {
+            cout << "No mission logs found.\n";
+        }
+        else
+        {
+            MissionAnalytics analytics;
+            Stopwatch sw;
+            vector<GroupResult> groups;
+            if (choice == 1)
+                groups = analytics.byDrone(reader);
+            else if (choice == 2)
+                groups = analytics.byRoute(reader, 15);
+            else
+                groups = analytics.byTime(reader);
+            double ms = sw.elapsedMs();
+
+            int keyWidth = choice == 2 ? 30 : 14;
+            printSeparator('-', keyWidth + 72);
+            cout << left << setw(keyWidth) << (choice == 1 ? "Drone" : choice == 2 ? "Route" : "Day")
+                 << setw(10) << "Missions"
+                 << setw(8) << "Done%"
+                 << setw(18) << "Dist avg/p50/p95"
+                 << setw(22) << "Batt/unit p50/p95/max"
+                 << "Time p50/p95\n";
+            printSeparator('-', keyWidth + 72);
+            for (size_t i = 0; i < groups.size(); i++)
+            {
+                const GroupStats &g = groups[i].stats;
+                stringstream dist, eff, time;
+                dist << fixed << setprecision(1) << g.distance.mean() << "/" << g.distance.quantile(0.5) << "/"
+                     << g.distance.quantile(0.95);
+                eff << fixed << setprecision(3) << g.efficiency.quantile(0.5) << "/" << g.efficiency.quantile(0.95)
+                    << "/" << g.efficiency.getMax();
+                time << fixed << setprecision(1) << g.duration.quantile(0.5) << "/" << g.duration.quantile(0.95);
+                cout << left << setw(keyWidth) << groups[i].key
+                     << setw(10) << g.missions
+                     << setw(8) << fixed << setprecision(1) << 100.0 * g.completed / g.missions
+                     << setw(18) << dist.str()
+                     << setw(22) << eff.str()
+                     << time.str() << "\n";
+            }
+            if (groups.size() < analytics.getGroupCount())
+                cout << "... " << analytics.getGroupCount() - groups.size() << " more routes\n";
+            cout << "\n" << analytics.getGroupCount() << " groups from " << reader.size() << " missions in "
+                 << setprecision(2) << ms << " ms on " << analytics.getThreadCount() << " threads"
+                 << " (quantiles within 1%)\n";
+        }
+
+        cout << "\nPress any key to continue...";
+        waitForKey();
     }
 
     void clearLogs()
@@ -353,14 +436,262 @@ public:
         }
     }
 
+    static const int kBenchmarkCount = 22;
+
+    void runBenchmark(int choice)
+    {
+        switch (choice)
+        {
+        case 1:
+        {
+            PathFinder3D classic(&map, 1.0);
+            classic.setCacheBudget(0);  // measure search, not cache hits
+            GridPathFinder grid(&map, 1.0);
+            auto queries = makeRandomQueries(map, 50);
+            benchPathFinderAB(map, classic, "PathFinder3D", grid, "GridPathFinder", queries);
+            break;
+        }
+        case 2:
+            cout << "\n";
+            pathFinder->printCacheStats();
+            break;
+        case 3:
+            benchSpatialIndex();
+            break;
+        case 4:
+            benchOccupancy(map);
+            break;
+        case 5:
+            benchSegmentClearance();
+            break;
+        case 6:
+            benchOpenSet(map);
+            break;
+        case 7:
+            benchBatchPlanning(map);
+            break;
+        case 8:
+            benchMissionLog();
+            break;
+        case 9:
+            benchMissionWriter();
+            break;
+        case 10:
+            benchMissionStats();
+            break;
+        case 11:
+            benchCSVParse();
+            break;
+        case 12:
+            benchMissionAnalytics();
+            break;
+        case 13:
+            benchPathKernels();
+            break;
+        case 14:
+            benchPathCacheEncoding();
+            break;
+        case 15:
+            benchHierarchical();
+            break;
+        case 16:
+            benchJumpPoint(map);
+            break;
+        case 17:
+            benchThetaStar(map);
+            break;
+        case 18:
+            benchBidirectional(map);
+            break;
+        case 19:
+            benchReplanning(map);
+            break;
+        case 20:
+            benchLandmarks(map);
+            break;
+        case 21:
+            benchOptimality(map);
+            break;
+        case 22:
+            benchFleet(map);
+            break;
+        }
+    }
+
+    void runBenchmarks()
+    {
+        cout << "\n--- Performance Benchmarks ---\n";
+        cout << "  1. A* engines: PathFinder3D vs GridPathFinder\n";
+        cout << "  2. Path cache statistics\n";
+        cout << "  3. Obstacle index: isBlocked cost vs obstacle count\n";
+        cout << "  4. Occupancy bitmap: bake cost, memory, planner speedup\n";
+        cout << "  5. Segment clearance: sampled vs exact\n";
+        cout << "  6. Open set: lazy heap vs indexed decrease-key heap\n";
+        cout << "  7. Batch planning throughput vs thread count\n";
+        cout << "  8. Mission log: CSV parse vs columnar scan\n";
+        cout << "  9. Mission log writes: per-record vs buffered\n";
+        cout << "  10. Mission statistics: recount vs running aggregates\n";
+        cout << "  11. Mission CSV parsing: tokenizer vs zero-copy scanner\n";
+        cout << "  12. Mission analytics: group-by scaling and sketch accuracy\n";
+        cout << "  13. Path kernels: AoS vs SoA scalar vs AVX2\n";
+        cout << "  14. Path cache: arena memory and waypoint encodings\n";
+        cout << "  15. Hierarchical planning (HPA*) on a 100x map\n";
+        cout << "  16. Jump point search: heap operations and A* cost parity\n";
+        cout << "  17. Any-angle Lazy Theta* vs A* + smoothing\n";
+        cout << "  18. Bidirectional A* on corner-to-corner routes\n";
+        cout << "  19. Incremental replanning (D* Lite) after a pop-up obstacle\n";
+        cout << "  20. Landmark (ALT) heuristic table: build cost and expansions saved\n";
+        cout << "  21. Path optimality regression vs brute-force Dijkstra\n";
+        cout << "  22. Fleet simulation: Drone objects vs SoA fixed-timestep engine\n";
+        cout << "  0. Back\n";
+        int choice = getInput<int>("Select benchmark: ", 0, kBenchmarkCount);
+        if (choice == 0)
+            return;
+
+        runBenchmark(choice);
+
+        cout << "\nPress any key to continue...";
+        waitForKey();
+    }
+
+    // mission log in the legacy CSV format (--export-csv)
+    void exportLog(const string &csvPath)
+    {
+        size_t rows = logger.exportCSV(csvPath);
+        cout << "Exported " << rows << " missions to " << csvPath << "\n";
+    }
+
+    // optimality regression only; the mismatch count becomes the exit status (--check-optimality)
+    int checkOptimality()
+    {
+        int mismatches = benchOptimality(map);
+        cout << (mismatches ? "\nOptimality check FAILED: " + to_string(mismatches) + " mismatched costs\n"
+                            : string("\nOptimality check passed\n"));
+        return mismatches;
+    }
+
+    // every benchmark in sequence, no prompts (--bench)
+    void runAllBenchmarks()
+    {
+        for (int i = 1; i <= kBenchmarkCount; i++)
+        {
+            runBenchmark(i);
+        }
+    }
+
+    // Fly many missions with no rendering and no frame delays (--headless N).
+    // Drones rotate through a fixed set of routes and recharge when a route is
+    // beyond their battery, so every mission runs the full plan + flight model.
+    // With logMissions every result goes to the mission log (--log).
+    void runHeadless(int missions, bool logMissions = false)
+    {
+        if (!simulator.isHeadless())
+            simulator.setRenderer(make_unique<HeadlessRenderer>());
+        auto routes = makeRandomQueries(map, min(missions, 200));
+        if (routes.empty())
+        {
+            cout << "No free routes on this map.\n";
+            return;
+        }
+
+        int completed = 0, emergencies = 0;
+        size_t waypoints = 0;
+        double flown = 0;
+        Stopwatch sw;
+        for (int i = 0; i < missions; i++)
+        {
+            Drone *drone = drones[i % drones.size()].get();
+            const PlanQuery &route = routes[i % routes.size()];
+
+            auto path = pathFinder->findPath(route.start, route.end);
+            if (!drone->getBattery().canTravel(pathLength(path)))
+                drone->getBattery().recharge();
+
+            double startBattery = drone->getBattery().getPercentage();
+            drone->resetDistance();
+            simulator.simulateFlight(*drone, map, path, route.start, route.end);
+            drone->incrementMission();
+
+            flown += drone->getTotalDistance();
+            waypoints += path.size();
+            bool ok = drone->getBattery().getPercentage() > 5;
+            if (ok)
+                completed++;
+            else
+                emergencies++;
+
+            if (logMissions)
+            {
+                MissionResult result;
+                result.droneId = drone->getId();
+                result.startPos = (string)route.start;
+                result.endPos = (string)route.end;
+                result.distance = drone->getTotalDistance();
+                result.batteryUsed = startBattery - drone->getBattery().getPercentage();
+                result.duration = result.distance / drone->getSpeed();
+                result.status = ok ? "Completed" : "Emergency Landing";
+                logger.logMission(result);
+            }
+        }
+        double ms = sw.elapsedMs();
+        if (logMissions)
+        {
+            Stopwatch barrier;
+            logger.flush();
+            cout << "Logged " << missions << " missions (final flush " << fixed << setprecision(2)
+                 << barrier.elapsedMs() << " ms)\n";
+        }
+
+        cout << "Headless run: " << missions << " missions on " << map.getName()
+             << " (" << routes.size() << " distinct routes)\n";
+        cout << "  Completed: " << completed << " | Emergency landings: " << emergencies << "\n";
+        cout << "  Waypoints flown: " << waypoints << " | Distance: " << fixed << setprecision(1)
+             << flown << " units\n";
+        cout << "  Time: " << setprecision(1) << ms << " ms ("
+             << setprecision(0) << (ms > 0 ? missions * 1000.0 / ms : 0.0) << " missions/s)\n";
+    }
+
+    // Step a fleet of headless drones at a fixed dt until all have landed (--fleet N).
+    // Fleet drones copy the speed and battery of the planner's drones in turn
+    // and fly the same rotation of routes as --headless.
+    void runFleet(size_t fleetSize, double dt = 0.1)
+    {
+        auto routes = makeRandomQueries(map, 200);
+        if (routes.empty())
+        {
+            cout << "No free routes on this map.\n";
+            return;
+        }
+        FleetSimulator fleet;
+        fleet.reserve(fleetSize);
+        for (const PlanQuery &route : routes)
+            fleet.addRoute(pathFinder->findPath(route.start, route.end));
+        for (size_t i = 0; i < fleetSize; i++)
+            fleet.addDrone(*drones[i % drones.size()], i % routes.size());
+
+        Stopwatch sw;
+        long steps = fleet.run(dt, 1000000);
+        double ms = sw.elapsedMs();
+
+        cout << "Fleet run: " << fleetSize << " drones on " << map.getName() << " (" << routes.size()
+             << " routes, " << fleet.threadCount() << " threads)\n";
+        cout << "  Arrived: " << fleet.countStatus(FLEET_ARRIVED) << " | Emergency landings: "
+             << fleet.countStatus(FLEET_EMERGENCY) << "\n";
+        cout << "  Simulated: " << fixed << setprecision(1) << fleet.getSimTime() << " s in " << steps
+             << " steps of " << setprecision(2) << dt << " s\n";
+        cout << "  Time: " << setprecision(1) << ms << " ms (" << setprecision(0)
+             << (ms > 0 ? steps * 1000.0 / ms : 0.0) << " steps/s, "
+             << (ms > 0 ? fleetSize * steps * 1000.0 / ms : 0.0) << " drone-steps/s)\n";
+    }
+
     void run()
     {
         int choice;
         do
         {
-            system("cls");
+            clearConsole();
             showMainMenu();
-            choice = getInput<int>("Enter choice: ", 0, 10);
+            choice = getInput<int>("Enter choice: ", 0, 12);
 
             switch (choice)
             {
@@ -394,6 +725,12 @@ public:
             case 10:
                 clearLogs();
                 break;
+            case 11:
+                runBenchmarks();
+                break;
+            case 12:
+                missionAnalytics();
+                break;
             case 0:
                 cout << "Exiting...\n";
                 break;
@@ -402,12 +739,86 @@ public:
     }
 };
 
-int main()
+static void printUsage(const char *program)
 {
+    cout << "Usage: " << program << " [--headless [missions]] [--log] [--fleet [drones]] [--bench] [--check-optimality] [--export-csv file]\n";
+    cout << "  (no options)         interactive menu\n";
+    cout << "  --headless [N]       fly N missions without rendering (default 1000)\n";
+    cout << "  --log                with --headless, write every mission to the mission log\n";
+    cout << "  --fleet [N]          step N drones at a fixed timestep until all land (default 10000)\n";
+    cout << "  --bench              run every performance benchmark and exit\n";
+    cout << "  --check-optimality   compare planner costs with brute force; exit 1 on any mismatch\n";
+    cout << "  --export-csv FILE    write the mission log as CSV and exit\n";
+}
+
+int main(int argc, char *argv[])
+{
+    int headlessMissions = 0;
+    size_t fleetSize = 0;
+    bool bench = false;
+    bool checkOptimality = false;
+    bool logHeadless = false;
+    string exportPath;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--headless") == 0)
+        {
+            headlessMissions = 1000;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                headlessMissions = max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--fleet") == 0)
+        {
+            fleetSize = 10000;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                fleetSize = (size_t)max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--log") == 0)
+        {
+            logHeadless = true;
+        }
+        else if (strcmp(argv[i], "--bench") == 0)
+        {
+            bench = true;
+        }
+        else if (strcmp(argv[i], "--check-optimality") == 0)
+        {
+            checkOptimality = true;
+        }
+        else if (strcmp(argv[i], "--export-csv") == 0 && i + 1 < argc)
+        {
+            exportPath = argv[++i];
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (headlessMissions > 0 || fleetSize > 0 || bench || checkOptimality || !exportPath.empty())
+    {
+        FlightPlanner planner(make_unique<HeadlessRenderer>());
+        int status = 0;
+        if (headlessMissions > 0)
+            planner.runHeadless(headlessMissions, logHeadless);
+        if (fleetSize > 0)
+            planner.runFleet(fleetSize);
+        if (bench)
+            planner.runAllBenchmarks();
+        if (checkOptimality && planner.checkOptimality() > 0)
+            status = 1;
+        if (!exportPath.empty())
+            planner.exportLog(exportPath);
+        return status;
+    }
+
+#ifdef _WIN32
     SetConsoleTitle(TEXT("Drone Flight Path Planner"));
 
     // Set console size
     system("mode con: cols=100 lines=40");
+#endif
 
     cout << "Initializing Drone Flight Path Planner...\n";
 
@@ -415,4 +826,4 @@ int main()
     planner.run();
 
     return 0;
-}
\ No newline at end of file
+}